@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+
+#include "Bind.hpp"
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+struct Address {
+    std::string city;
+    uint32_t zip = 0;
+};
+struct Person {
+    int64_t id = 0;
+    std::string name;
+    std::string email;
+    double score = 0;
+    bool active = false;
+    std::vector<std::string> tags;
+    std::optional<Address> address;
+};
+} // namespace
+
+template <>
+constexpr auto json_fields<Address> =
+    std::tuple{JSON_FIELD(Address, city), JSON_FIELD(Address, zip)};
+template <>
+constexpr auto json_fields<Person> = std::tuple{
+    JSON_FIELD(Person, id),     JSON_FIELD(Person, name),
+    JSON_FIELD(Person, email),  JSON_FIELD(Person, score),
+    JSON_FIELD(Person, active), JSON_FIELD(Person, tags),
+    JSON_FIELD(Person, address)};
+
+namespace {
+const std::string &people() {
+    static const std::string doc = []() {
+        std::string doc = "[";
+        for (int i = 0; i < 20000; ++i) {
+            auto n = std::to_string(i);
+            doc += R"({"id":)" + n + R"(,"name":"person number )" + n +
+                   R"(","email":"person)" + n + R"(@example.com","score":)" +
+                   n + R"(.25,"active":true,"tags":["alpha","beta"],)" +
+                   R"("address":{"city":"city of )" + n + R"(","zip":)" + n +
+                   "}},";
+        }
+        doc.back() = ']';
+        return doc;
+    }();
+    return doc;
+}
+
+// what binding code without parse_into looks like
+Person to_person(const Json &json) {
+    Person person;
+    person.id = json["id"].as<int64_t>();
+    person.name = json["name"].as<std::string_view>();
+    person.email = json["email"].as<std::string_view>();
+    person.score = json["score"].as<double>();
+    person.active = json["active"].as<bool>();
+    for (const auto &tag : json["tags"].as<Json::arraytype>()) {
+        person.tags.emplace_back(tag.as<std::string_view>());
+    }
+    const auto &address = json["address"];
+    if (address.get_type() != Json::Type::NULL_) {
+        person.address = Address{
+            std::string(address["city"].as<std::string_view>()),
+            static_cast<uint32_t>(address["zip"].as<int64_t>())};
+    }
+    return person;
+}
+
+Json from_person(const Person &person) {
+    auto *resource = std::pmr::get_default_resource();
+    Json json(ObjectType{}, resource);
+    json["id"] = Json(person.id);
+    json["name"] = Json(person.name);
+    json["email"] = Json(person.email);
+    json["score"] = Json(person.score);
+    json["active"] = Json(person.active);
+    Json tags(ArrayType{}, resource);
+    for (const auto &tag : person.tags) {
+        tags.append(Json(tag));
+    }
+    json["tags"] = std::move(tags);
+    if (person.address) {
+        Json address(ObjectType{}, resource);
+        address["city"] = Json(person.address->city);
+        address["zip"] = Json(int64_t{person.address->zip});
+        json["address"] = std::move(address);
+    } else {
+        json["address"] = Json(Null{});
+    }
+    return json;
+}
+} // namespace
+
+// NOLINTBEGIN
+static void BM_bind_parse_then_convert(benchmark::State &state) {
+    const auto &doc = people();
+    for (auto _ : state) {
+        auto json = inline_parse(doc);
+        std::vector<Person> result;
+        for (const auto &item : json.as<Json::arraytype>()) {
+            result.push_back(to_person(item));
+        }
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_bind_parse_then_convert)->Unit(benchmark::kMillisecond);
+
+static void BM_bind_parse_into(benchmark::State &state) {
+    const auto &doc = people();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parse_into<std::vector<Person>>(doc));
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_bind_parse_into)->Unit(benchmark::kMillisecond);
+
+static void BM_bind_convert_then_dump(benchmark::State &state) {
+    auto result = parse_into<std::vector<Person>>(people());
+    for (auto _ : state) {
+        Json json(ArrayType{}, std::pmr::get_default_resource());
+        for (const auto &person : result) {
+            json.append(from_person(person));
+        }
+        std::string out;
+        json.dump_to(out, 0);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * people().size());
+}
+BENCHMARK(BM_bind_convert_then_dump)->Unit(benchmark::kMillisecond);
+
+static void BM_bind_dump_struct(benchmark::State &state) {
+    auto result = parse_into<std::vector<Person>>(people());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dump_struct(result));
+    }
+    state.SetBytesProcessed(state.iterations() * people().size());
+}
+BENCHMARK(BM_bind_dump_struct)->Unit(benchmark::kMillisecond);
+// NOLINTEND
@@ -0,0 +1,34 @@
+#include <benchmark/benchmark.h>
+
+#include "Reader.hpp"
+#include <string>
+
+namespace {
+std::string array_of_objects(size_t count) {
+    std::string s = "[";
+    for (size_t i = 0; i < count; ++i) {
+        if (i != 0) {
+            s += ",";
+        }
+        s += R"({"id":)" + std::to_string(i) +
+             R"(,"name":"item","tags":["a","b","c"],"ok":true,"v":null})";
+    }
+    s += "]";
+    return s;
+}
+} // namespace
+
+// NOLINTBEGIN
+static void BM_threaded_parse_array_of_objects(benchmark::State &state) {
+    auto doc = array_of_objects(state.range(0));
+    auto tokens = Lexer(doc).dump_tokens().size();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(threaded_parse(doc));
+    }
+    state.SetItemsProcessed(state.iterations() * tokens);
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_threaded_parse_array_of_objects)->Arg(1 << 10)->Arg(1 << 14)->UseRealTime();
+// NOLINTEND
+
+BENCHMARK_MAIN();
@@ -0,0 +1,300 @@
+#include <benchmark/benchmark.h>
+
+#include "Reader.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+#include <string>
+#include <vector>
+
+// Standard corpora, each run through Lexer::dump_tokens, threaded_parse and
+// Json::dump, plus the memory a parsed document keeps per node. To compare
+// over time, keep the output of
+//   xmake run bench --benchmark_filter=corpus --benchmark_out=FILE
+//   --benchmark_out_format=json
+// and diff two files with Google Benchmark's tools/compare.py.
+
+namespace {
+std::atomic<uint64_t> allocations{0};
+std::atomic<int64_t> live_bytes{0}; // as malloc_usable_size reports them
+} // namespace
+
+// 统计整个进程的堆分配次数 (包括 worker 线程). Kept out of line: inlined
+// into a caller, GCC reports the malloc/free pair as mismatched new/delete.
+[[gnu::noinline]] void *operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size == 0 ? 1 : size)) {
+        live_bytes.fetch_add(static_cast<int64_t>(malloc_usable_size(p)),
+                             std::memory_order_relaxed);
+        return p;
+    }
+    throw std::bad_alloc();
+}
+[[gnu::noinline]] void operator delete(void *p) noexcept {
+    live_bytes.fetch_sub(static_cast<int64_t>(malloc_usable_size(p)),
+                         std::memory_order_relaxed);
+    std::free(p);
+}
+[[gnu::noinline]] void operator delete(void *p, size_t) noexcept {
+    operator delete(p);
+}
+// std::pmr::new_delete_resource allocates through these
+[[gnu::noinline]] void *operator new(size_t size, std::align_val_t align) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    auto alignment = static_cast<size_t>(align);
+    size = (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    if (void *p = std::aligned_alloc(alignment, size)) {
+        live_bytes.fetch_add(static_cast<int64_t>(malloc_usable_size(p)),
+                             std::memory_order_relaxed);
+        return p;
+    }
+    throw std::bad_alloc();
+}
+[[gnu::noinline]] void operator delete(void *p, std::align_val_t) noexcept {
+    operator delete(p);
+}
+[[gnu::noinline]] void operator delete(void *p, size_t,
+                                       std::align_val_t) noexcept {
+    operator delete(p);
+}
+
+namespace {
+// xorshift64, so the corpora are the same on every platform and standard
+// library (std::uniform_*_distribution are not)
+class Random {
+  public:
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+    uint64_t below(uint64_t n) { return next() % n; }
+
+  private:
+    uint64_t state = 0x9E3779B97F4A7C15;
+};
+
+// A corpus is a list of documents; all but NDJSON hold a single one.
+using Corpus = std::vector<std::string>;
+
+Corpus deep() {
+    Random random;
+    std::string doc = "[";
+    for (int i = 0; i < 2000; ++i) {
+        auto depth = 100 + random.below(400);
+        for (uint64_t d = 0; d < depth; ++d) {
+            doc += d % 2 == 0 ? "[" : R"({"k":)";
+        }
+        doc += std::to_string(i);
+        for (auto d = depth; d-- > 0;) {
+            doc += d % 2 == 0 ? "]" : "}";
+        }
+        doc += i + 1 < 2000 ? "," : "]";
+    }
+    return {doc};
+}
+
+Corpus wide() {
+    Random random;
+    std::string doc = "[";
+    for (int i = 0; i < 20; ++i) {
+        doc += "{";
+        for (int k = 0; k < 5000; ++k) {
+            doc += "\"key_" + std::to_string(random.next() % 1000000) + "_" +
+                   std::to_string(k) + "\":" + std::to_string(random.below(1000));
+            doc += k + 1 < 5000 ? "," : "}";
+        }
+        doc += i + 1 < 20 ? "," : "]";
+    }
+    return {doc};
+}
+
+Corpus numbers() {
+    Random random;
+    std::string doc = "[";
+    for (int i = 0; i < 200000; ++i) {
+        auto n = random.next();
+        switch (i % 4) {
+        case 0: // small integers
+            doc += std::to_string(static_cast<int64_t>(n % 2000) - 1000);
+            break;
+        case 1: // large integers
+            doc += std::to_string(static_cast<int64_t>(n >> 1));
+            break;
+        case 2: // decimals
+            doc += std::to_string(n % 100000) + "." +
+                   std::to_string(n / 100000 % 1000000);
+            break;
+        default: // exponents
+            doc += "-" + std::to_string(n % 10) + "." +
+                   std::to_string(n / 10 % 1000) + "e" +
+                   std::to_string(static_cast<int>(n / 10000 % 600) - 300);
+            break;
+        }
+        doc += i + 1 < 200000 ? "," : "]";
+    }
+    return {doc};
+}
+
+Corpus strings() {
+    static const char *const pieces[] = {"plain text ", "\\\"quoted\\\" ",
+                                         "back\\\\slash ", "line\\nbreak ",
+                                         "tab\\tstop ", "\\u0041\\u00e9 ",
+                                         "\\/path\\/ "};
+    Random random;
+    std::string doc = "[";
+    for (int i = 0; i < 50000; ++i) {
+        doc += "\"";
+        for (auto n = 1 + random.below(6); n > 0; --n) {
+            doc += pieces[random.below(std::size(pieces))];
+        }
+        doc += i + 1 < 50000 ? "\"," : "\"]";
+    }
+    return {doc};
+}
+
+Corpus unicode() {
+    static const char *const pieces[] = {
+        "中文文本 ", "日本語のテキスト ", "Ελληνικά ", "русский текст ",
+        "emoji 😀🚀 ", "\\ud83d\\ude00 ", "\\u4e2d\\u6587 ", "ascii "};
+    Random random;
+    std::string doc = "[";
+    for (int i = 0; i < 50000; ++i) {
+        doc += "\"";
+        for (auto n = 1 + random.below(6); n > 0; --n) {
+            doc += pieces[random.below(std::size(pieces))];
+        }
+        doc += i + 1 < 50000 ? "\"," : "\"]";
+    }
+    return {doc};
+}
+
+Corpus ndjson() {
+    Random random;
+    Corpus lines;
+    for (int i = 0; i < 20000; ++i) {
+        lines.push_back(R"({"id":)" + std::to_string(i) + R"(,"user":"user_)" +
+                        std::to_string(random.below(5000)) +
+                        R"(","score":)" + std::to_string(random.below(100)) +
+                        "." + std::to_string(random.below(100)) +
+                        R"(,"tags":["a","b"],"active":)" +
+                        (random.below(2) == 0 ? "true" : "false") + "}");
+    }
+    return lines;
+}
+
+const Corpus &corpus(Corpus (*make)()) {
+    // generated once per process, outside any timed region
+    static std::vector<std::pair<Corpus (*)(), Corpus>> cache;
+    for (const auto &[key, value] : cache) {
+        if (key == make) {
+            return value;
+        }
+    }
+    return cache.emplace_back(make, make()).second;
+}
+
+size_t total_size(const Corpus &docs) {
+    size_t size = 0;
+    for (const auto &doc : docs) {
+        size += doc.size();
+    }
+    return size;
+}
+
+// MB/s of input, documents/s and heap allocations per document
+template <class Body>
+void run(benchmark::State &state, const Corpus &docs, Body body) {
+    auto before = allocations.load();
+    for (auto _ : state) {
+        for (const auto &doc : docs) {
+            body(doc);
+        }
+    }
+    auto count = static_cast<double>(state.iterations() * docs.size());
+    state.SetBytesProcessed(state.iterations() * total_size(docs));
+    state.counters["docs"] = benchmark::Counter(
+        count, benchmark::Counter::kIsRate);
+    state.counters["allocs/doc"] =
+        static_cast<double>(allocations.load() - before) / count;
+}
+
+// NOLINTBEGIN(*-no-recursion)
+size_t count_nodes(const Json &json) {
+    size_t count = 1;
+    if (json.get_type() == Json::Type::ARRAY) {
+        for (const auto &element : json.as<Json::arraytype>()) {
+            count += count_nodes(element);
+        }
+    } else if (json.get_type() == Json::Type::OBJECT) {
+        for (const auto &[key, value] : json.as<Json::objecttype>()) {
+            count += count_nodes(value);
+        }
+    }
+    return count;
+}
+// NOLINTEND(*-no-recursion)
+} // namespace
+
+// NOLINTBEGIN
+static void BM_corpus_dump_tokens(benchmark::State &state, Corpus (*make)()) {
+    run(state, corpus(make), [](const std::string &doc) {
+        benchmark::DoNotOptimize(Lexer(doc).dump_tokens());
+    });
+}
+static void BM_corpus_threaded_parse(benchmark::State &state,
+                                     Corpus (*make)()) {
+    run(state, corpus(make), [](const std::string &doc) {
+        benchmark::DoNotOptimize(threaded_parse(doc));
+    });
+}
+static void BM_corpus_dump(benchmark::State &state, Corpus (*make)()) {
+    const auto &docs = corpus(make);
+    std::vector<Json> parsed;
+    for (const auto &doc : docs) {
+        parsed.push_back(inline_parse(doc));
+    }
+    auto next = parsed.begin();
+    // bytes are counted against the input, as for the other stages
+    run(state, docs, [&](const std::string &) {
+        benchmark::DoNotOptimize(next->dump());
+        if (++next == parsed.end()) {
+            next = parsed.begin();
+        }
+    });
+}
+// Heap bytes a parsed document holds (its root included) per value in it.
+static void BM_corpus_memory(benchmark::State &state, Corpus (*make)()) {
+    const auto &docs = corpus(make);
+    int64_t bytes = 0;
+    size_t nodes = 0;
+    for (auto _ : state) {
+        bytes = 0;
+        nodes = 0;
+        for (const auto &doc : docs) {
+            auto before = live_bytes.load();
+            auto json = inline_parse(doc);
+            bytes += live_bytes.load() - before +
+                     static_cast<int64_t>(sizeof(Json));
+            nodes += count_nodes(json);
+        }
+    }
+    state.counters["bytes/node"] =
+        static_cast<double>(bytes) / static_cast<double>(nodes);
+}
+#define CORPUS_BENCHMARKS(name)                                               \
+    BENCHMARK_CAPTURE(BM_corpus_dump_tokens, name, name)->UseRealTime();      \
+    BENCHMARK_CAPTURE(BM_corpus_threaded_parse, name, name)->UseRealTime();   \
+    BENCHMARK_CAPTURE(BM_corpus_dump, name, name)->UseRealTime();             \
+    BENCHMARK_CAPTURE(BM_corpus_memory, name, name)->Iterations(1)
+CORPUS_BENCHMARKS(deep);
+CORPUS_BENCHMARKS(wide);
+CORPUS_BENCHMARKS(numbers);
+CORPUS_BENCHMARKS(strings);
+CORPUS_BENCHMARKS(unicode);
+CORPUS_BENCHMARKS(ndjson);
+// NOLINTEND
@@ -0,0 +1,19 @@
+#include <benchmark/benchmark.h>
+
+#include "Reader.hpp"
+#include <string_view>
+
+namespace {
+constexpr std::string_view record =
+    R"({"ts":1690000000,"level":"info","msg":"request served","status":200})";
+}
+
+// NOLINTBEGIN
+static void BM_threaded_parse_small_record(benchmark::State &state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(threaded_parse(record));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_threaded_parse_small_record)->UseRealTime();
+// NOLINTEND
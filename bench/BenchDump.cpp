@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+
+#include "JsonWriter.hpp"
+#include "Reader.hpp"
+#include <string>
+
+namespace {
+const Json &records() {
+    static const Json json = []() {
+        std::string doc = "[";
+        for (int i = 0; i < 50000; ++i) {
+            doc += R"({"id":)" + std::to_string(i) +
+                   R"(,"name":"record number )" + std::to_string(i) +
+                   R"(","active":true,"scores":[0.25,1.5,2.75,3]},)";
+        }
+        doc += "{}]";
+        return inline_parse(doc);
+    }();
+    return json;
+}
+} // namespace
+
+// NOLINTBEGIN
+static void BM_dump(benchmark::State &state) {
+    const auto &json = records();
+    size_t bytes = 0;
+    for (auto _ : state) {
+        auto out = json.dump(static_cast<int>(state.range(0)));
+        bytes += out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_dump)->Arg(0)->Arg(4);
+
+static void BM_dump_to_reused_buffer(benchmark::State &state) {
+    const auto &json = records();
+    std::string out;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        out.clear();
+        json.dump_to(out, static_cast<int>(state.range(0)));
+        bytes += out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_dump_to_reused_buffer)->Arg(0)->Arg(4);
+
+// The records above, produced from scratch: through a Json tree, or
+// written directly.
+static void BM_build_and_dump(benchmark::State &state) {
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        Json array(ArrayType{});
+        for (int i = 0; i < 50000; ++i) {
+            Json record(ObjectType{});
+            record["id"] = Json(i);
+            record["name"] =
+                Json(StringType{}, "record number " + std::to_string(i));
+            record["active"] = Json(true);
+            Json scores(ArrayType{});
+            for (double score : {0.25, 1.5, 2.75, 3.0}) {
+                scores.emplace_back(score);
+            }
+            record["scores"] = std::move(scores);
+            array.append(std::move(record));
+        }
+        array.dump_to(out, 0);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+BENCHMARK(BM_build_and_dump);
+
+static void BM_writer(benchmark::State &state) {
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        JsonWriter writer(out, 0);
+        writer.begin_array();
+        for (int i = 0; i < 50000; ++i) {
+            writer.begin_object().key("id").value(i);
+            writer.key("name").value("record number " + std::to_string(i));
+            writer.key("active").value(true).key("scores").begin_array();
+            for (double score : {0.25, 1.5, 2.75, 3.0}) {
+                writer.value(score);
+            }
+            writer.end_array().end_object();
+        }
+        writer.end_array().finish();
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+BENCHMARK(BM_writer);
+// NOLINTEND
@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+
+#include "Reader.hpp"
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// log lines, every 20th one cut short or with a stray byte
+const std::vector<std::string> &lines() {
+    static const std::vector<std::string> lines = []() {
+        std::vector<std::string> lines;
+        for (int i = 0; i < 2000; ++i) {
+            std::string line = R"({"ts":)" + std::to_string(1690000000 + i) +
+                               R"(,"level":"info","msg":"request served",)"
+                               R"("status":200})";
+            if (i % 40 == 0) {
+                line.resize(line.size() / 2);
+            } else if (i % 40 == 20) {
+                line.insert(line.size() - 1, "x");
+            }
+            lines.push_back(std::move(line));
+        }
+        return lines;
+    }();
+    return lines;
+}
+} // namespace
+
+// NOLINTBEGIN
+static void BM_lines_throwing(benchmark::State &state) {
+    std::pmr::monotonic_buffer_resource arena;
+    size_t failed = 0;
+    for (auto _ : state) {
+        failed = 0;
+        for (const auto &line : lines()) {
+            try {
+                benchmark::DoNotOptimize(inline_parse(line, &arena));
+            } catch (const std::runtime_error &error) {
+                benchmark::DoNotOptimize(error.what());
+                ++failed;
+            }
+            arena.release();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * lines().size());
+    state.counters["failed"] = static_cast<double>(failed);
+}
+BENCHMARK(BM_lines_throwing);
+
+static void BM_lines_try_parse(benchmark::State &state) {
+    std::pmr::monotonic_buffer_resource arena;
+    size_t failed = 0;
+    for (auto _ : state) {
+        failed = 0;
+        for (const auto &line : lines()) {
+            {
+                auto result = try_parse(line, &arena);
+                if (!result) {
+                    benchmark::DoNotOptimize(result.error().offset);
+                    ++failed;
+                }
+                benchmark::DoNotOptimize(result);
+            }
+            arena.release();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * lines().size());
+    state.counters["failed"] = static_cast<double>(failed);
+}
+BENCHMARK(BM_lines_try_parse);
+// NOLINTEND
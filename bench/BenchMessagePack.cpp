@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+
+#include "MessagePack.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+// the same records as text and as MessagePack, in files so both loads go
+// through the page cache the way a warm on-disk cache would
+struct CacheFiles {
+    std::string text_path = "/tmp/bench_cache.json";
+    std::string msgpack_path = "/tmp/bench_cache.msgpack";
+    size_t text_size = 0;
+
+    CacheFiles() {
+        std::string doc = "[";
+        for (int i = 0; i < 100000; ++i) {
+            auto n = std::to_string(i);
+            doc += R"({"id":)" + n + R"(,"name":"record number )" + n +
+                   R"(","score":)" + n + R"(.5,"tags":["alpha","beta"],)" +
+                   R"("ok":true,"parent":null},)";
+        }
+        doc.back() = ']';
+        text_size = doc.size();
+        std::ofstream(text_path, std::ios::binary) << doc;
+        std::ofstream(msgpack_path, std::ios::binary)
+            << to_msgpack(inline_parse(doc));
+    }
+    CacheFiles(const CacheFiles &) = delete;
+    CacheFiles &operator=(const CacheFiles &) = delete;
+    ~CacheFiles() {
+        std::remove(text_path.c_str());
+        std::remove(msgpack_path.c_str());
+    }
+};
+const CacheFiles &files() {
+    static const CacheFiles files;
+    return files;
+}
+} // namespace
+
+// NOLINTBEGIN
+static void BM_cache_load_text(benchmark::State &state) {
+    const auto &cache = files();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            parse_file(cache.text_path, inline_parse_threshold,
+                       {.borrow_strings = true}));
+    }
+    state.SetBytesProcessed(state.iterations() * cache.text_size);
+}
+BENCHMARK(BM_cache_load_text)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_cache_load_msgpack(benchmark::State &state) {
+    const auto &cache = files();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(load_msgpack_file(cache.msgpack_path));
+    }
+    // against the text size, so MB/s compare directly
+    state.SetBytesProcessed(state.iterations() * cache.text_size);
+}
+BENCHMARK(BM_cache_load_msgpack)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_cache_encode_msgpack(benchmark::State &state) {
+    auto document = parse_file(files().text_path);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(to_msgpack(document.root));
+    }
+    state.SetBytesProcessed(state.iterations() * files().text_size);
+}
+BENCHMARK(BM_cache_encode_msgpack)->Unit(benchmark::kMillisecond);
+// NOLINTEND
@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include "Reader.hpp"
+#include <cstdio>
+#include <string>
+
+namespace {
+// GeoJSON-like FeatureCollection: integer ids and long coordinate arrays.
+const std::string &geojson() {
+    static const std::string doc = []() {
+        std::string doc = R"({"type":"FeatureCollection","features":[)";
+        char buffer[64];
+        for (int feature = 0; feature < 200; ++feature) {
+            doc += R"({"type":"Feature","id":)" +
+                   std::to_string(9007199254740993LL + feature) +
+                   R"(,"geometry":{"type":"Polygon","coordinates":[[)";
+            for (int point = 0; point < 500; ++point) {
+                std::snprintf(buffer, sizeof(buffer), "[%.8f,%.8f],",
+                              -122.4 + feature * 0.001 + point * 1e-6,
+                              37.7 + point * 1e-6);
+                doc += buffer;
+            }
+            doc.back() = ']';
+            doc += R"(]},"properties":{"population":)" +
+                   std::to_string(feature * 1234) + "}},";
+        }
+        doc.back() = ']';
+        doc += "}";
+        return doc;
+    }();
+    return doc;
+}
+} // namespace
+
+// NOLINTBEGIN
+static void BM_parse_geojson(benchmark::State &state) {
+    const auto &doc = geojson();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(inline_parse(doc));
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_parse_geojson);
+
+// Pass-through: parse and dump without reading the numbers.
+static void BM_roundtrip_geojson(benchmark::State &state) {
+    const auto &doc = geojson();
+    ParseOptions options{.raw_numbers = state.range(0) != 0};
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        inline_parse(doc, std::pmr::get_default_resource(), options)
+            .dump_to(out, 0);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_roundtrip_geojson)->Arg(0)->Arg(1);
+
+static void BM_dump_geojson(benchmark::State &state) {
+    auto json = inline_parse(geojson());
+    size_t bytes = 0;
+    for (auto _ : state) {
+        auto out = json.dump(0);
+        bytes += out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_dump_geojson);
+
+namespace {
+std::string integers() {
+    std::string doc = "[";
+    for (int i = 0; i < 100000; ++i) {
+        doc += std::to_string(i * 7919LL) + ",";
+    }
+    doc.back() = ']';
+    return doc;
+}
+} // namespace
+
+static void BM_lex_integers(benchmark::State &state) {
+    auto doc = integers();
+    for (auto _ : state) {
+        Lexer lexer(doc);
+        while (lexer.get_next_token().type != Token::Type::EOF_) {
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_lex_integers);
+
+static void BM_parse_integers(benchmark::State &state) {
+    auto doc = integers();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(inline_parse(doc));
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_parse_integers);
+// NOLINTEND
@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+
+#include "Reader.hpp"
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+
+namespace {
+constexpr int record_count = 20000;
+constexpr int field_count = 20;
+
+// Records that all share the same 20 keys.
+const std::string &records() {
+    static const std::string doc = []() {
+        std::string doc = "[";
+        for (int i = 0; i < record_count; ++i) {
+            doc += "{";
+            for (int k = 0; k < field_count; ++k) {
+                doc += "\"field_" + std::to_string(k) + "\":";
+                doc += k % 2 == 0 ? std::to_string(i * k) : "\"v\"";
+                doc += k + 1 < field_count ? "," : "}";
+            }
+            doc += i + 1 < record_count ? "," : "]";
+        }
+        return doc;
+    }();
+    return doc;
+}
+
+// Counts the bytes a document's containers take from their resource.
+class CountingResource : public std::pmr::memory_resource {
+  public:
+    size_t bytes = 0;
+
+  private:
+    void *do_allocate(size_t size, size_t alignment) override {
+        bytes += size;
+        return std::pmr::new_delete_resource()->allocate(size, alignment);
+    }
+    void do_deallocate(void *p, size_t size, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+    }
+    bool do_is_equal(const memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+};
+} // namespace
+
+// NOLINTBEGIN
+static void BM_parse_records_memory(benchmark::State &state) {
+    const auto &doc = records();
+    size_t bytes = 0;
+    for (auto _ : state) {
+        CountingResource counting;
+        benchmark::DoNotOptimize(inline_parse(doc, &counting));
+        bytes = counting.bytes;
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+    state.counters["bytes_per_object"] =
+        static_cast<double>(bytes) / record_count;
+    state.counters["sizeof_Json"] = sizeof(Json);
+}
+BENCHMARK(BM_parse_records_memory);
+
+static void BM_object_lookup(benchmark::State &state) {
+    auto json = inline_parse(records());
+    const auto &record = json[record_count / 2];
+    for (auto _ : state) {
+        for (int k = 0; k < field_count; k += 3) {
+            benchmark::DoNotOptimize(
+                record["field_" + std::to_string(k)]);
+        }
+    }
+}
+BENCHMARK(BM_object_lookup);
+// NOLINTEND
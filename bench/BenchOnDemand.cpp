@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include "OnDemand.hpp"
+#include <cstdint>
+#include <string>
+
+namespace {
+// {"meta": ..., "data": {"items": [20000 records]}}
+const std::string &payload() {
+    static const std::string doc = []() {
+        std::string doc = R"({"meta":{"count":20000},"data":{"items":[)";
+        for (int i = 0; i < 20000; ++i) {
+            doc += R"({"id":)" + std::to_string(i) +
+                   R"(,"name":"item \"number\" )" + std::to_string(i) +
+                   R"(","tags":["a","b",{"deep":[1,2,3]}],"score":0.5},)";
+        }
+        doc.back() = ']';
+        doc += "}}";
+        return doc;
+    }();
+    return doc;
+}
+} // namespace
+
+// NOLINTBEGIN
+static void BM_field_full_parse(benchmark::State &state) {
+    const auto &doc = payload();
+    for (auto _ : state) {
+        auto json = inline_parse(doc);
+        benchmark::DoNotOptimize(json["data"]["items"][15000]["id"]);
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_field_full_parse);
+
+static void BM_field_on_demand(benchmark::State &state) {
+    const auto &doc = payload();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parse_pointer(doc, "/data/items/15000/id"));
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_field_on_demand);
+
+static void BM_field_on_demand_front(benchmark::State &state) {
+    const auto &doc = payload();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parse_pointer(doc, "/meta/count"));
+    }
+}
+BENCHMARK(BM_field_on_demand_front);
+
+static void BM_all_ids_on_demand(benchmark::State &state) {
+    const auto &doc = payload();
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto item : LazyValue(doc)["data"]["items"].elements()) {
+            sum += item["id"].parse().as<int64_t>();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_all_ids_on_demand);
+// NOLINTEND
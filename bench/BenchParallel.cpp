@@ -0,0 +1,64 @@
+#include <benchmark/benchmark.h>
+
+#include "Reader.hpp"
+#include "WorkerPool.hpp"
+#include <map>
+#include <memory>
+#include <string>
+
+namespace {
+// one large top-level array of ~24 MB
+const std::string &payload() {
+    static const std::string doc = []() {
+        std::string doc = "[";
+        for (int i = 0; i < 200000; ++i) {
+            doc += R"({"id":)" + std::to_string(i) +
+                   R"(,"name":"item \"number\" )" + std::to_string(i) +
+                   R"(","tags":["a","b",{"deep":[1,2,3]}],"score":0.5},)";
+        }
+        doc.back() = ']';
+        return doc;
+    }();
+    return doc;
+}
+
+// the caller takes part too, so `threads` participants need threads-1 workers
+WorkerPool &pool_for(size_t threads) {
+    static std::map<size_t, std::unique_ptr<WorkerPool>> pools;
+    auto &pool = pools[threads];
+    if (!pool) {
+        pool = std::make_unique<WorkerPool>(threads - 1);
+    }
+    return *pool;
+}
+} // namespace
+
+// NOLINTBEGIN
+static void BM_array_threaded_parse(benchmark::State &state) {
+    const auto &doc = payload();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(threaded_parse(doc));
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_array_threaded_parse)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+static void BM_array_parallel_parse(benchmark::State &state) {
+    const auto &doc = payload();
+    auto &pool = pool_for(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parallel_parse(doc, pool));
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_array_parallel_parse)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+// NOLINTEND
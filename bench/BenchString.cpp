@@ -0,0 +1,52 @@
+#include <benchmark/benchmark.h>
+
+#include "Reader.hpp"
+#include "Scan.hpp"
+#include <string>
+
+namespace {
+std::string quoted(size_t length) {
+    std::string s = "\"";
+    for (size_t i = 0; i < length; ++i) {
+        s.push_back(static_cast<char>('a' + i % 26));
+    }
+    return s + "\"";
+}
+} // namespace
+
+// NOLINTBEGIN
+static void BM_lex_string(benchmark::State &state) {
+    auto doc = quoted(state.range(0));
+    for (auto _ : state) {
+        Lexer lexer(doc);
+        benchmark::DoNotOptimize(lexer.get_next_token());
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_lex_string)->Arg(8)->Arg(128)->Arg(4096);
+
+template <const char *(*scan)(const char *, const char *)>
+static void BM_find_string_special(benchmark::State &state) {
+    auto doc = quoted(state.range(0));
+    const char *begin = doc.data() + 1;
+    const char *end = doc.data() + doc.size();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(scan(begin, end));
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_find_string_special<find_string_special_scalar>)
+    ->Arg(8)
+    ->Arg(128)
+    ->Arg(4096);
+#if defined(__x86_64__) || defined(__i386__)
+BENCHMARK(BM_find_string_special<find_string_special_sse2>)
+    ->Arg(8)
+    ->Arg(128)
+    ->Arg(4096);
+BENCHMARK(BM_find_string_special<find_string_special_avx2>)
+    ->Arg(8)
+    ->Arg(128)
+    ->Arg(4096);
+#endif
+// NOLINTEND
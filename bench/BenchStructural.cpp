@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+
+#include "Reader.hpp"
+#include "Structural.hpp"
+#include <string>
+
+namespace {
+// Pretty-printed records, so there is whitespace for stage 1 to skip.
+const std::string &records() {
+    static const std::string doc = []() {
+        Json array(ArrayType{});
+        for (int i = 0; i < 20000; ++i) {
+            Json record(ObjectType{});
+            record["id"] = Json(static_cast<double>(i));
+            record["name"] = Json(std::string("record number ") +
+                                  std::to_string(i));
+            record["active"] = Json(i % 2 == 0);
+            Json scores(ArrayType{});
+            for (int k = 0; k < 4; ++k) {
+                scores.append(Json(i * 0.25 + k));
+            }
+            record["scores"] = std::move(scores);
+            array.append(std::move(record));
+        }
+        return array.dump(4);
+    }();
+    return doc;
+}
+} // namespace
+
+// NOLINTBEGIN
+static void BM_structural_index(benchmark::State &state) {
+    const auto &doc = records();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(build_structural_index(doc));
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_structural_index);
+
+static void BM_inline_parse_records(benchmark::State &state) {
+    const auto &doc = records();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(inline_parse(doc));
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_inline_parse_records);
+
+static void BM_indexed_parse_records(benchmark::State &state) {
+    const auto &doc = records();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(indexed_parse(doc));
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_indexed_parse_records);
+// NOLINTEND
@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+
+#include "Tape.hpp"
+#include <string>
+
+namespace {
+// [20000 records], each 13 values
+const std::string &records() {
+    static const std::string doc = []() {
+        std::string doc = "[";
+        for (int i = 0; i < 20000; ++i) {
+            doc += R"({"id":)" + std::to_string(i) +
+                   R"(,"name":"item \"number\" )" + std::to_string(i) +
+                   R"(","tags":["a","b",{"deep":[1,2,3]}],"score":0.5},)";
+        }
+        doc.back() = ']';
+        return doc;
+    }();
+    return doc;
+}
+} // namespace
+
+// NOLINTBEGIN
+static void BM_tape_parse_dom(benchmark::State &state) {
+    const auto &doc = records();
+    for (auto _ : state) {
+        auto document = parse_document(doc);
+        benchmark::DoNotOptimize(document.root);
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+BENCHMARK(BM_tape_parse_dom);
+
+static void BM_tape_parse_tape(benchmark::State &state) {
+    const auto &doc = records();
+    size_t bytes = 0;
+    for (auto _ : state) {
+        auto tape = tape_parse(doc);
+        bytes = tape.tape_size() * sizeof(uint64_t) + tape.string_bytes();
+        benchmark::DoNotOptimize(tape);
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+    state.counters["tape_bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_tape_parse_tape);
+
+// sum of every record's id and score
+static void BM_tape_traverse_dom(benchmark::State &state) {
+    auto document = parse_document(records());
+    for (auto _ : state) {
+        double sum = 0;
+        for (const auto &record : document.root.as<Json::arraytype>()) {
+            sum += record["id"].as<double>() + record["score"].as<double>();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_tape_traverse_dom);
+
+static void BM_tape_traverse_tape(benchmark::State &state) {
+    auto tape = tape_parse(records());
+    for (auto _ : state) {
+        double sum = 0;
+        for (auto record : tape.root()) {
+            sum += record["id"].as<double>() + record["score"].as<double>();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_tape_traverse_tape);
+
+static void BM_tape_dump_dom(benchmark::State &state) {
+    auto document = parse_document(records());
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        document.root.dump_to(out, 0);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+BENCHMARK(BM_tape_dump_dom);
+
+static void BM_tape_dump_tape(benchmark::State &state) {
+    auto tape = tape_parse(records());
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        tape.dump_to(out, 0);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+BENCHMARK(BM_tape_dump_tape);
+// NOLINTEND
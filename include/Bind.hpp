@@ -0,0 +1,224 @@
+#ifndef BIND_HPP
+#define BIND_HPP
+#include "Reader.hpp"
+#include "json.hpp"
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Binds C++ structs to JSON without building a Json in between. A struct
+// is made bindable by specializing json_fields with its members:
+//
+//   struct Point { int x; double y; std::optional<std::string> label; };
+//   template <>
+//   constexpr auto json_fields<Point> = std::tuple{
+//       JSON_FIELD(Point, x), JSON_FIELD(Point, y), JSON_FIELD(Point, label)};
+//
+//   auto point = parse_into<Point>(R"({"x":1,"y":2.5})");
+//   auto text = dump_struct(point); // {"x":1,"y":2.5,"label":null}
+//
+// Members may be bool, arithmetic types, std::string, Json, std::optional
+// (null), std::vector (arrays) and other bound structs. Keys are matched
+// against the names known at compile time; unknown keys are validated and
+// skipped, missing ones keep their default value.
+template <class Class, class Member> struct JsonField {
+    std::string_view name; // written as is, must not need escaping
+    Member Class::*member;
+};
+#define JSON_FIELD(Type, member) JsonField{#member, &Type::member}
+
+template <class T> constexpr auto json_fields = nullptr;
+
+template <class T>
+concept JsonBound =
+    !std::is_same_v<std::remove_cv_t<decltype(json_fields<T>)>, std::nullptr_t>;
+
+// Reads values straight from a Lexer's tokens. Errors are reported like
+// the parser's, as "line:column: message".
+class StructReader {
+  public:
+    explicit StructReader(Lexer &lexer) : lexer(&lexer) { advance(); }
+
+    template <class T> void read(T &value);
+    // The document must end after the value.
+    void finish();
+
+  private:
+    Lexer *lexer;
+    Token token; // the next unread token
+    Token key;   // the last key read, until its value is dispatched
+
+    void advance() { token = lexer->get_next_token(); }
+    [[noreturn]] static void error(const Token &token, const char *messgae);
+    void expect(Token::Type type, const char *messgae);
+    // Consumes `end` and returns true if it is next.
+    bool close(Token::Type end);
+    // After an element: true on a comma, false on `end`.
+    bool separator(Token::Type end);
+    std::string_view read_key();
+
+    void read_bool(bool &value);
+    int64_t read_integer(int64_t min, int64_t max);
+    uint64_t read_unsigned(uint64_t max);
+    double read_double();
+    void read_string(std::string &value);
+    void read_json(Json &value);
+    void skip();
+    // Skips the value of a key no field is bound to; `unknown` holds the
+    // ones met so far in this object.
+    void skip_unknown(std::string_view name,
+                      std::unordered_set<std::string> &unknown);
+    void consume(SaxHandler &handler);
+
+    template <class T, size_t... I>
+    void read_member(T &value, std::string_view name, uint64_t &seen,
+                     std::unordered_set<std::string> &unknown,
+                     std::index_sequence<I...> /*unused*/);
+};
+
+template <class T> struct IsOptional : std::false_type {};
+template <class T> struct IsOptional<std::optional<T>> : std::true_type {};
+template <class T> struct IsVector : std::false_type {};
+template <class T, class A>
+struct IsVector<std::vector<T, A>> : std::true_type {};
+
+template <class T> void StructReader::read(T &value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        read_bool(value);
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        value = static_cast<T>(read_integer(std::numeric_limits<T>::min(),
+                                            std::numeric_limits<T>::max()));
+    } else if constexpr (std::is_integral_v<T>) {
+        value = static_cast<T>(read_unsigned(std::numeric_limits<T>::max()));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        value = static_cast<T>(read_double());
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        read_string(value);
+    } else if constexpr (std::is_same_v<T, Json>) {
+        read_json(value);
+    } else if constexpr (IsOptional<T>::value) {
+        if (token.type == Token::Type::NULL_) {
+            value.reset();
+            advance();
+        } else {
+            read(value.emplace());
+        }
+    } else if constexpr (IsVector<T>::value) {
+        expect(Token::Type::BEGIN_ARRAY, "Array expected");
+        value.clear();
+        if (!close(Token::Type::END_ARRAY)) {
+            do {
+                read(value.emplace_back());
+            } while (separator(Token::Type::END_ARRAY));
+        }
+    } else {
+        static_assert(JsonBound<T>, "specialize json_fields for this type");
+        constexpr auto count = std::tuple_size_v<decltype(json_fields<T>)>;
+        static_assert(count <= 64, "duplicates are tracked in 64 bits");
+        expect(Token::Type::BEGIN_OBJECT, "Object expected");
+        if (close(Token::Type::END_OBJECT)) {
+            return;
+        }
+        uint64_t seen = 0;
+        std::unordered_set<std::string> unknown;
+        do {
+            read_member(value, read_key(), seen, unknown,
+                        std::make_index_sequence<count>());
+        } while (separator(Token::Type::END_OBJECT));
+    }
+}
+
+template <class T, size_t... I>
+void StructReader::read_member(T &value, std::string_view name,
+                               uint64_t &seen,
+                               std::unordered_set<std::string> &unknown,
+                               std::index_sequence<I...> /*unused*/) {
+    constexpr const auto &fields = json_fields<T>;
+    auto match = [&](const auto &field, uint64_t bit) {
+        if (name != field.name) {
+            return false;
+        }
+        if ((seen & bit) != 0) {
+            error(key, "Duplicate object key");
+        }
+        seen |= bit;
+        read(value.*field.member);
+        return true;
+    };
+    if (!(match(std::get<I>(fields), uint64_t{1} << I) || ...)) {
+        skip_unknown(name, unknown);
+    }
+}
+
+// Builds a T from `data`, which must hold exactly one value of its shape.
+template <class T>
+T parse_into(std::string_view data, ParseOptions options = {}) {
+    Lexer lexer(data, options);
+    StructReader reader(lexer);
+    T value{};
+    reader.read(value);
+    reader.finish();
+    return value;
+}
+
+// Appends `value` as compact JSON; bound structs write every field, in
+// declaration order.
+template <class T> void dump_struct_to(std::string &out, const T &value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        out.append(value ? "true" : "false");
+    } else if constexpr (std::is_integral_v<T>) {
+        char buffer[24]; // NOLINT: 20 digits and a sign
+        auto p = std::to_chars(std::begin(buffer), std::end(buffer), value);
+        out.append(std::begin(buffer), p.ptr);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        dump_number_to(out, static_cast<double>(value));
+    } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+        dump_string_to(out, value);
+    } else if constexpr (std::is_same_v<T, Json>) {
+        value.dump_to(out, 0);
+    } else if constexpr (IsOptional<T>::value) {
+        if (value) {
+            dump_struct_to(out, *value);
+        } else {
+            out.append("null");
+        }
+    } else if constexpr (IsVector<T>::value) {
+        out.push_back('[');
+        for (size_t i = 0; i < value.size(); ++i) {
+            if (i != 0) {
+                out.push_back(',');
+            }
+            dump_struct_to(out, value[i]);
+        }
+        out.push_back(']');
+    } else {
+        static_assert(JsonBound<T>, "specialize json_fields for this type");
+        out.push_back('{');
+        bool first = true;
+        std::apply(
+            [&](const auto &...field) {
+                ((out.append(first ? "\"" : ",\""), first = false,
+                  out.append(field.name), out.append("\":"),
+                  dump_struct_to(out, value.*field.member)),
+                 ...);
+            },
+            json_fields<T>);
+        out.push_back('}');
+    }
+}
+template <class T> std::string dump_struct(const T &value) {
+    std::string out;
+    dump_struct_to(out, value);
+    return out;
+}
+#endif // BIND_HPP
@@ -0,0 +1,43 @@
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+#include "Reader.hpp"
+#include "Sax.hpp"
+#include <string>
+#include <string_view>
+
+// Push-style parser for a document that arrives in chunks. Every complete
+// token in a chunk is lexed and handed to `handler` right away; only a
+// token cut off by the end of the chunk (a string, a `\u` escape, a number
+// or a literal) is carried over to the next feed(). Memory therefore stays
+// bounded by the chunk size plus the longest token, plus whatever the
+// handler keeps.
+//
+// Chunks don't need to outlive feed(), so nothing is borrowed from them
+// (ParseOptions::borrow_strings and raw_numbers are ignored). After an
+// error is thrown the parser can't be used any more.
+class IncrementalParser {
+  public:
+    explicit IncrementalParser(SaxHandler &handler, ParseOptions options = {})
+        : sax(handler), options(options) {
+        this->options.borrow_strings = false;
+        this->options.raw_numbers = false;
+    }
+
+    void feed(std::string_view chunk);
+    // Marks the end of input; throws if the document is incomplete.
+    void finish();
+
+  private:
+    SaxParser sax;
+    ParseOptions options;
+    std::string pending; // unlexed tail: at most one incomplete token
+    int lineno = 1;
+    int colnom = 1;
+    // string state at the end of `pending`, so only new bytes are scanned
+    bool in_string = false;
+    bool escaped = false;
+
+    size_t scan(std::string_view buffer, size_t from);
+    void lex(std::string_view data, bool last);
+};
+#endif // INCREMENTAL_HPP
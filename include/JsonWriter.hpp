@@ -0,0 +1,93 @@
+#ifndef JSONWRITER_HPP
+#define JSONWRITER_HPP
+#include "json.hpp"
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Writes a document as it is described, without building a Json first:
+//
+//   JsonWriter writer(out, 0);
+//   writer.begin_object().key("id").value(7).key("tags").begin_array();
+//   writer.value("a").value("b").end_array().end_object().finish();
+//   // out: {"id":7,"tags":["a","b"]}
+//
+// The output is what Json::dump(size) writes for the same document. Calls
+// out of place (a value without its key, an unmatched end, a second
+// top-level value) throw std::logic_error, and so does finish() on an
+// unfinished document.
+class JsonWriter {
+  public:
+    constexpr static size_t flush_size = 64 * 1024;
+
+    // Appends to `out`.
+    explicit JsonWriter(std::string &out, int size = 4)
+        : out(&out), size(size) {}
+    // Stream to `os` / `fd` through one reused buffer, flushed whenever it
+    // passes flush_size and by finish().
+    explicit JsonWriter(std::ostream &os, int size = 4);
+    explicit JsonWriter(int fd, int size = 4);
+    JsonWriter(const JsonWriter &) = delete;
+    JsonWriter &operator=(const JsonWriter &) = delete;
+
+    JsonWriter &begin_array();
+    JsonWriter &end_array();
+    JsonWriter &begin_object();
+    JsonWriter &end_object();
+    JsonWriter &key(std::string_view key);
+
+    JsonWriter &null();
+    JsonWriter &value(bool value);
+    template <std::integral T>
+        requires(!std::is_same_v<T, bool>)
+    JsonWriter &value(T value);
+    JsonWriter &value(double value);
+    JsonWriter &value(std::string_view value);
+    JsonWriter &value(const char *value) {
+        return this->value(std::string_view(value));
+    }
+    // Number text written as is; it must be valid JSON.
+    JsonWriter &value(RawNumber value);
+
+    // Whether a whole document has been written.
+    bool complete() const { return done; }
+    // Checks that the document is complete and flushes the stream.
+    void finish();
+
+  private:
+    struct Frame {
+        bool object;
+        bool first; // nothing written in it yet
+    };
+    std::string buffer; // streaming only
+    std::string *out;   // `buffer` when streaming
+    int size;
+    std::function<void(std::string_view)> sink;
+    std::vector<Frame> frames;
+    bool after_key = false;
+    bool done = false;
+
+    void before_value();
+    void after_value();
+    void end(bool object);
+    void newline(size_t level);
+};
+
+template <std::integral T>
+    requires(!std::is_same_v<T, bool>)
+JsonWriter &JsonWriter::value(T value) {
+    before_value();
+    char digits[24]; // NOLINT: 20 digits and a sign
+    auto p = std::to_chars(std::begin(digits), std::end(digits), value);
+    out->append(std::begin(digits), p.ptr);
+    after_value();
+    return *this;
+}
+#endif // JSONWRITER_HPP
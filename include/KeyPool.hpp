@@ -0,0 +1,51 @@
+#ifndef KEYPOOL_HPP
+#define KEYPOOL_HPP
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_set>
+
+// Interns object keys so every object of a document shares one copy of
+// each distinct key, and equal keys can be compared by pointer. A parser
+// creates one pool per document; objects hold a reference to it.
+//
+// Reference counting is thread-safe, interning is not: objects that share
+// a pool must not get new keys from two threads at once.
+class KeyPool {
+  public:
+    // A new pool holding one reference.
+    static KeyPool *create() { return new KeyPool; }
+    KeyPool(const KeyPool &) = delete;
+    KeyPool &operator=(const KeyPool &) = delete;
+
+    // Deleter for a std::unique_ptr that owns one reference.
+    struct Release {
+        void operator()(KeyPool *pool) const noexcept { pool->release(); }
+    };
+
+    void retain() noexcept { refs.fetch_add(1, std::memory_order_relaxed); }
+    void release() noexcept {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    // The pooled copy of `key`; it stays valid as long as the pool.
+    std::string_view intern(std::string_view key);
+    // The pooled copy of `key`, or nullptr if it was never interned.
+    const std::string_view *find(std::string_view key) const {
+        auto it = keys.find(key);
+        return it == keys.end() ? nullptr : &*it;
+    }
+    size_t size() const { return keys.size(); }
+
+  private:
+    KeyPool() = default;
+    ~KeyPool() = default;
+
+    std::atomic<size_t> refs{1};
+    std::pmr::monotonic_buffer_resource storage;
+    std::pmr::unordered_set<std::string_view> keys{&storage};
+};
+#endif // KEYPOOL_HPP
@@ -0,0 +1,29 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only view of a whole file. Regular files are mmap'ed (with
+// MADV_SEQUENTIAL) so the lexer reads the page cache directly; pipes and
+// other unmappable inputs fall back to reading into a buffer. Throws
+// std::runtime_error when the file can't be opened or read.
+class MappedFile {
+  public:
+    explicit MappedFile(const std::string &path);
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    [[nodiscard]] std::string_view view() const {
+        return mapping != nullptr ? std::string_view(mapping, length)
+                                  : std::string_view(buffer);
+    }
+    [[nodiscard]] bool mapped() const { return mapping != nullptr; }
+
+  private:
+    const char *mapping = nullptr;
+    size_t length = 0;
+    std::string buffer; // used when the file can't be mapped
+};
+#endif // MAPPEDFILE_HPP
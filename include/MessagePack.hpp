@@ -0,0 +1,36 @@
+#ifndef MESSAGEPACK_HPP
+#define MESSAGEPACK_HPP
+#include "Reader.hpp"
+#include "json.hpp"
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+struct SaxHandler;
+
+// MessagePack encoding of the Json value model: nil, true/false, integers
+// in the smallest int/uint format that holds them, doubles as float 64,
+// strings as str, arrays and maps with string keys. Raw numbers are
+// converted before they are written. Decoding integers gives int64_t (or
+// uint64_t above INT64_MAX) and float 32/64 gives double, so a document
+// comes back exactly as the text parser would have built it.
+void to_msgpack(const Json &json, std::string &out);
+std::string to_msgpack(const Json &json);
+
+// Decodes the single value that must fill `data`, as SaxHandler events.
+// With options.borrow_strings, strings are passed as views into `data`.
+// Throws std::runtime_error "msgpack: ... at offset N" on malformed input,
+// types outside the model (bin, ext) and duplicate keys.
+void from_msgpack(std::string_view data, SaxHandler &handler,
+                  ParseOptions options = {});
+Json from_msgpack(std::string_view data,
+                  std::pmr::memory_resource *resource =
+                      std::pmr::get_default_resource(),
+                  ParseOptions options = {});
+
+// Maps a file written with to_msgpack and decodes it in place into an
+// arena; strings stay views into the mapping unless `options` say
+// otherwise. This is the fast way back from an on-disk cache.
+Document load_msgpack_file(const std::string &path,
+                           ParseOptions options = {.borrow_strings = true});
+#endif // MESSAGEPACK_HPP
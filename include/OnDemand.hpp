@@ -0,0 +1,123 @@
+#ifndef ONDEMAND_HPP
+#define ONDEMAND_HPP
+#include "Reader.hpp"
+#include "json.hpp"
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+
+struct LazyMember;
+template <class Item> class LazyIterator;
+template <class Item> struct LazyRange;
+
+// A value inside a document that hasn't been parsed yet. Looking up a
+// member or element walks forward from the value's first byte and skips
+// every sibling before it by counting brackets (strings are jumped over
+// with the SIMD scanner) without building tokens or Json for it; only
+// parse() materializes anything.
+//
+// Every lookup starts over from the value's first byte; to visit many
+// elements or members, walk elements() / members() instead, which go on
+// from where the previous step stopped.
+//
+// Skipped values are not validated, so a lookup can succeed on a document
+// that parse() would reject. The input must outlive every LazyValue made
+// from it. Malformed input met along the way throws std::runtime_error.
+class LazyValue {
+  public:
+    // The root value of `document`.
+    explicit LazyValue(std::string_view document);
+
+    // From the first byte only; throws when no value can start there.
+    Json::Type get_type() const;
+
+    // Object member / array element, or std::nullopt if there is none.
+    // Throw std::logic_error on the wrong type, like Json::operator[].
+    std::optional<LazyValue> find(std::string_view key) const;
+    std::optional<LazyValue> find(size_t index) const;
+    // RFC 6901 JSON Pointer relative to this value, e.g. "/data/items/3/id".
+    std::optional<LazyValue> find_pointer(std::string_view pointer) const;
+    // Like find, but throw std::out_of_range when missing.
+    LazyValue operator[](std::string_view key) const;
+    LazyValue operator[](size_t index) const;
+
+    // The elements of an array / the members of an object, in order.
+    // Throw std::logic_error on the wrong type.
+    LazyRange<LazyValue> elements() const;
+    LazyRange<LazyMember> members() const;
+
+    // The value's source text.
+    std::string_view raw() const;
+    Json parse(std::pmr::memory_resource *resource =
+                   std::pmr::get_default_resource(),
+               ParseOptions options = {}) const;
+
+  private:
+    template <class Item> friend class LazyIterator;
+    LazyValue(const char *begin, const char *end) : begin(begin), end(end) {}
+
+    const char *begin; // first byte of the value
+    const char *end;   // end of the whole input
+};
+
+struct LazyMember {
+    std::string_view raw_key; // between the quotes, escapes as written
+    LazyValue value;
+
+    // raw_key with its escapes decoded.
+    std::string key() const;
+};
+
+// Forward iterator over a LazyValue's elements (Item = LazyValue) or
+// members (Item = LazyMember). Each step skips only the item it leaves,
+// so a whole pass reads the container once. A default-constructed
+// iterator is the end.
+template <class Item> class LazyIterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = Item;
+    using reference = Item;
+    using pointer = void;
+
+    LazyIterator() = default;
+
+    Item operator*() const;
+    LazyIterator &operator++();
+    LazyIterator operator++(int) {
+        auto copy = *this;
+        ++*this;
+        return copy;
+    }
+    bool operator==(const LazyIterator &other) const {
+        return value == other.value;
+    }
+
+  private:
+    friend class LazyValue;
+    // `p` is where the first item, or the closing bracket, may start.
+    LazyIterator(const char *p, const char *end);
+    void read_item(const char *p);
+
+    std::string_view raw_key;     // members only
+    const char *value = nullptr;  // nullptr past the last item
+    const char *end = nullptr;
+};
+
+template <class Item> struct LazyRange {
+    LazyIterator<Item> first;
+
+    LazyIterator<Item> begin() const { return first; }
+    LazyIterator<Item> end() const { return {}; }
+};
+
+// Parses only the value at `pointer` in `data`, skipping everything else.
+std::optional<Json> parse_pointer(std::string_view data,
+                                  std::string_view pointer,
+                                  std::pmr::memory_resource *resource =
+                                      std::pmr::get_default_resource(),
+                                  ParseOptions options = {});
+#endif // ONDEMAND_HPP
@@ -1,10 +1,16 @@
 #ifndef READER_HPP
 #define READER_HPP
+#include "MappedFile.hpp"
+#include "Stats.hpp"
+#include "Structural.hpp"
 #include "json.hpp"
-#include <condition_variable>
-#include <deque>
+#include <atomic>
+#include <cstdint>
 #include <exception>
-#include <mutex>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <variant>
 #include <vector>
@@ -25,34 +31,152 @@ struct Token {
         NUMBER,
         STRING
     } type;
-    std::variant<std::string, double> value{};
+    // std::string_view only for strings borrowed from the input, or for the
+    // text of a number under ParseOptions::raw_numbers; integers
+    // without fraction or exponent stay exact as int64_t, or uint64_t above
+    // INT64_MAX
+    std::variant<std::string, double, std::string_view, int64_t, uint64_t>
+        value{};
 
     std::string get_type() const;
     std::string get_value() const;
 };
 
+struct ParseOptions {
+    // Strings without escapes are kept as views into the input instead of
+    // being copied, all the way into the Json. The input must then outlive
+    // every token and Json produced from it.
+    bool borrow_strings = false;
+    // Numbers are only validated, not converted: tokens carry their source
+    // text and the Json holds a RawNumber that converts when read and dumps
+    // verbatim. Same lifetime rule as borrow_strings.
+    bool raw_numbers = false;
+    // Counters to fill in; only used in builds with JSON_PARSER_STATS (see
+    // Stats.hpp). One parse at a time: parallel_parse and the per-line
+    // parsers of the CLI batch mode leave it alone.
+    ParseStats *stats = nullptr;
+};
+
+// Why and where a document was rejected. `line` and `column` are the ones
+// the exception messages carry (for a token, the column just after it);
+// `offset` is the byte offset of the same position in the input.
+struct ParseError {
+    enum class Kind : uint8_t {
+        VALUE_EXPECTED,
+        UNEXPECTED_CHARACTER,
+        INVALID_STRING_CHARACTER,
+        INVALID_ESCAPE,
+        INVALID_UNICODE,
+        UNTERMINATED_STRING,
+        INVALID_NUMBER,
+        NUMBER_OUT_OF_RANGE,
+        UNTERMINATED_NUMBER,
+        COLON_EXPECTED,
+        PROPERTY_EXPECTED,
+        DUPLICATE_KEY,
+        COMMA_OR_BRACKET_EXPECTED,
+        END_OF_FILE_EXPECTED,
+    };
+    Kind kind;
+    size_t offset;
+    int line;
+    int column;
+
+    // The text for `kind`, e.g. "Value expected".
+    static const char *describe(Kind kind);
+    // "line:column: text", as thrown by the throwing API.
+    std::string message() const;
+};
+
+// What try_parse returns: the value, or the error that stopped the parse.
+class ParseResult {
+  public:
+    ParseResult(Json value) : value_(std::move(value)) {} // NOLINT
+    ParseResult(ParseError error) : error_(error) {}      // NOLINT
+
+    bool has_value() const { return !error_; }
+    explicit operator bool() const { return has_value(); }
+    // Throws std::runtime_error with error().message() when there is no
+    // value, like the throwing parsers.
+    Json &value() & {
+        check();
+        return value_;
+    }
+    Json &&value() && {
+        check();
+        return std::move(value_);
+    }
+    Json &operator*() { return value_; }
+    Json *operator->() { return &value_; }
+    // Only valid without a value.
+    const ParseError &error() const { return *error_; }
+
+  private:
+    Json value_;
+    std::optional<ParseError> error_;
+
+    void check() const {
+        if (error_) {
+            throw std::runtime_error(error_->message());
+        }
+    }
+};
+
 struct Lexer {
   private:
     int lineno = 1;
     int colnom = 1;
     std::string_view data_;
     std::string_view::iterator curr_pos;
+    ParseOptions options;
+    const StructuralIndex *structurals = nullptr;
+    size_t next_structural = 0;
+    std::optional<ParseError> error_;
 
   public:
-    explicit Lexer(std::string_view data)
-        : data_(data), curr_pos(data_.begin()) {}
+    explicit Lexer(std::string_view data, ParseOptions options = {})
+        : data_(data), curr_pos(data_.begin()), options(options) {}
+    // Jumps straight to the token starts recorded in `index` instead of
+    // skipping whitespace. Token line/column are not tracked in this mode.
+    Lexer(std::string_view data, const StructuralIndex &index,
+          ParseOptions options = {})
+        : data_(data), curr_pos(data_.begin()), options(options),
+          structurals(&index) {}
+    // Continues line/column counting from where a previous Lexer stopped,
+    // for input that arrives in pieces.
+    Lexer(std::string_view data, int lineno, int colnom,
+          ParseOptions options = {})
+        : lineno(lineno), colnom(colnom), data_(data),
+          curr_pos(data_.begin()), options(options) {}
+
+    int line() const { return lineno; }
+    int column() const { return colnom; }
+    ParseStats *stats() const { return options.stats; }
 
     Token get_next_token();
+    // Like get_next_token, but malformed input ends the tokens: an EOF_
+    // token is returned and error() is set, without throwing.
+    Token try_next_token();
+    const std::optional<ParseError> &error() const { return error_; }
+    size_t offset() const { return curr_pos - data_.begin(); }
     std::vector<Token> dump_tokens();
 
   private:
+    Token scan_token();
+    Token lex_token();
+    Token get_indexed_token();
     Token generate_token(Token::Type type, std::string value) const;
+    Token generate_token(Token::Type type, std::string_view value) const;
     Token generate_token(Token::Type type, double value) const;
+    Token generate_token(Token::Type type, int64_t value) const;
+    Token generate_token(Token::Type type, uint64_t value) const;
     Token generate_token(Token::Type type) const;
 
     Token get_string();
     Token get_number();
-    [[noreturn]] void error(const char *messgae) const;
+    Token get_raw_number();
+    // Records the error and ends the input; returns the EOF_ token.
+    Token fail(ParseError::Kind kind);
 
     void skip_ws();
     void inline next(int step = 1) {
@@ -65,42 +189,249 @@ struct Lexer {
     }
 };
 
-struct Parser {
-    mutable std::mutex m;
-    mutable std::condition_variable cv;
-    std::deque<Token> tokens;
-    bool stop = false;
-    std::deque<Token>::const_iterator curr(int k = 0) const{
-        std::unique_lock<std::mutex> lk(m);
-        cv.wait(lk, [this, k](){return stop || tokens.size() > k;});
-        if(stop){
+// Bounded single-producer/single-consumer ring between the lexer thread and
+// the parser thread. Both sides keep private cursors and only publish them
+// once per batch, so the shared cache lines are touched once every
+// `batch_size` tokens instead of once per token.
+class TokenChannel {
+  public:
+    static constexpr size_t capacity = 1024; // power of two
+    static constexpr size_t batch_size = 32;
+
+    explicit TokenChannel(ParseStats *stats = nullptr)
+        : slots(capacity), stats_(stats) {}
+
+    // consumer side
+    Token *peek(size_t k = 0) {
+        while (cached_head <= read_pos + k) {
+            wait_readable(k);
+        }
+        return &slots[(read_pos + k) & (capacity - 1)];
+    }
+    void pop() {
+        peek();
+        ++read_pos;
+        if (read_pos - published_read >= batch_size) {
+            publish_read();
+        }
+    }
+
+    // producer side
+    void push(Token token) {
+        while (write_pos - cached_tail >= capacity) {
+            wait_writable();
+        }
+        auto eof = token.type == Token::Type::EOF_;
+        slots[write_pos & (capacity - 1)] = std::move(token);
+        ++write_pos;
+        if (eof || write_pos - published_write >= batch_size) {
+            publish_write();
+        }
+    }
+
+    // Producer side of close(): what was pushed is still read first.
+    void close_write() {
+        if (published_write != write_pos) {
+            publish_write();
+        }
+        close();
+    }
+
+    void close() {
+        stopped.store(true, std::memory_order_release);
+        signal();
+    }
+    bool closed() const { return stopped.load(std::memory_order_acquire); }
+    ParseStats *stats() const { return stats_; }
+
+  private:
+    std::vector<Token> slots;
+    ParseStats *stats_; // wait times
+
+    alignas(64) std::atomic<size_t> head{0}; // written by producer
+    alignas(64) std::atomic<size_t> tail{0}; // written by consumer
+    alignas(64) std::atomic<unsigned> epoch{0};
+    std::atomic<bool> stopped{false};
+
+    alignas(64) size_t write_pos = 0;
+    size_t published_write = 0;
+    size_t cached_tail = 0;
+
+    alignas(64) size_t read_pos = 0;
+    size_t published_read = 0;
+    size_t cached_head = 0;
+
+    void signal() {
+        epoch.fetch_add(1, std::memory_order_acq_rel);
+        epoch.notify_all();
+    }
+    void publish_write() {
+        published_write = write_pos;
+        head.store(write_pos, std::memory_order_release);
+        signal();
+    }
+    void publish_read() {
+        published_read = read_pos;
+        tail.store(read_pos, std::memory_order_release);
+        signal();
+    }
+    void wait_readable(size_t k) {
+        if (published_read != read_pos) {
+            publish_read();
+        }
+        auto e = epoch.load(std::memory_order_acquire);
+        cached_head = head.load(std::memory_order_acquire);
+        if (cached_head > read_pos + k) {
+            return;
+        }
+        if (closed()) {
+            // the producer publishes before closing: look once more
+            cached_head = head.load(std::memory_order_acquire);
+            if (cached_head > read_pos + k) {
+                return;
+            }
+            throw 0;
+        }
+        StatsTimer timer(stats_, &ParseStats::parser_wait_ns);
+        epoch.wait(e, std::memory_order_acquire);
+    }
+    void wait_writable() {
+        if (published_write != write_pos) {
+            publish_write();
+        }
+        auto e = epoch.load(std::memory_order_acquire);
+        cached_tail = tail.load(std::memory_order_acquire);
+        if (write_pos - cached_tail < capacity) {
+            return;
+        }
+        if (closed()) {
             throw 0;
         }
-        return tokens.cbegin() + k;
+        StatsTimer timer(stats_, &ParseStats::lexer_wait_ns);
+        epoch.wait(e, std::memory_order_acquire);
+    }
+};
+
+struct SaxHandler;
+class WorkerPool;
+class Tape;
+
+// Parser reads tokens either from a TokenChannel fed by another thread or
+// straight from a Lexer on the calling thread.
+struct Parser {
+    explicit Parser(TokenChannel &channel,
+                    std::pmr::memory_resource *resource =
+                        std::pmr::get_default_resource())
+        : channel(&channel), resource(resource), stats(channel.stats()) {}
+    explicit Parser(Lexer &lexer, std::pmr::memory_resource *resource =
+                                      std::pmr::get_default_resource())
+        : lexer(&lexer), resource(resource), stats(lexer.stats()) {}
+
+    // tokens are owned by the parser, so values may be moved out of them
+    Token *curr(int k = 0) const {
+        if (channel != nullptr) {
+            return channel->peek(k);
+        }
+        while (ahead_size <= k) {
+            ahead[(ahead_begin + ahead_size) % lookahead] =
+                lexer->get_next_token();
+            ++ahead_size;
+        }
+        return &ahead[(ahead_begin + k) % lookahead];
     }
-    Parser() = default;
 
     Json parse();
-    Json parse_value();
-    Json parse_object();
-    Json parse_array();
-    [[noreturn]] void error(const char *messgae) const;
-    void inline next(int step = 1){
-        while(step--){
-            std::unique_lock<std::mutex> lk(m);
-            cv.wait(lk, [this](){return stop || !tokens.empty();});
-            if(stop){
-                throw 0;
+    void parse(SaxHandler &handler);
+    // Like parse, without exceptions for malformed input. Only for a
+    // Parser reading from a Lexer, before it has been used.
+    ParseResult try_parse();
+    std::optional<ParseError> try_parse(SaxHandler &handler);
+    // The document as a Tape (Tape.hpp) instead of a Json tree.
+    Tape parse_tape();
+    void inline next(int step = 1) {
+        while (step--) {
+            if (channel != nullptr) {
+                channel->pop();
+                continue;
             }
-            tokens.pop_front();
+            curr();
+            ahead_begin = (ahead_begin + 1) % lookahead;
+            --ahead_size;
         }
     }
-    void push(Token token){
-        std::unique_lock<std::mutex> lk(m);
-        tokens.emplace_back(std::move(token));
-        cv.notify_one();
-    }
+
+  private:
+    static constexpr int lookahead = 2; // curr(1) is the furthest we peek
+    TokenChannel *channel = nullptr;
+    Lexer *lexer = nullptr;
+    std::pmr::memory_resource *resource; // containers of the parsed document
+    ParseStats *stats;
+    mutable Token ahead[lookahead]{};
+    mutable int ahead_begin = 0;
+    mutable int ahead_size = 0;
 };
 
-Json threaded_parse(std::string_view data);
+// Documents smaller than this are parsed on the calling thread; handing
+// them to the lexer worker costs more than it saves.
+constexpr size_t inline_parse_threshold = 64 * 1024;
+
+// Builds the structural index of `data` first, then parses by jumping from
+// token to token. Produces the same Json (and the same error messages) as
+// inline_parse.
+Json indexed_parse(std::string_view data,
+                   std::pmr::memory_resource *resource =
+                       std::pmr::get_default_resource(),
+                   ParseOptions options = {});
+Json inline_parse(std::string_view data,
+                  std::pmr::memory_resource *resource =
+                      std::pmr::get_default_resource(),
+                  ParseOptions options = {});
+// inline_parse without exceptions for malformed input: the error comes
+// back with its kind, byte offset, line and column. inline_parse is this
+// plus ParseResult::value().
+ParseResult try_parse(std::string_view data,
+                      std::pmr::memory_resource *resource =
+                          std::pmr::get_default_resource(),
+                      ParseOptions options = {});
+Json threaded_parse(std::string_view data,
+                    size_t threshold = inline_parse_threshold,
+                    std::pmr::memory_resource *resource =
+                        std::pmr::get_default_resource(),
+                    ParseOptions options = {});
+
+// Parses a document whose top level is one big array on every thread of
+// `pool`: the input is cut into chunks, string state and nesting depth are
+// resolved per chunk in parallel to find the top-level element boundaries,
+// the elements are parsed in parallel and moved into one array in order.
+// Anything else (not an array, unbalanced brackets, any parse error) goes
+// to threaded_parse, so results and error messages are the same as there.
+// `resource` must be safe to use from several threads at once, which the
+// default one is and a monotonic arena is not.
+Json parallel_parse(std::string_view data, WorkerPool &pool,
+                    std::pmr::memory_resource *resource =
+                        std::pmr::get_default_resource(),
+                    ParseOptions options = {});
+// Same on WorkerPool::instance().
+Json parallel_parse(std::string_view data,
+                    std::pmr::memory_resource *resource =
+                        std::pmr::get_default_resource(),
+                    ParseOptions options = {});
+
+// A parsed document whose containers all live in one monotonic arena. The
+// arena is released in one shot when the Document goes away, so `root` must
+// not outlive it (copy it out if it has to). Documents read with parse_file
+// also keep the mapped input alive, so borrowed strings stay valid.
+struct Document {
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+    Json root;
+    std::unique_ptr<MappedFile> source = nullptr;
+};
+Document parse_document(std::string_view data,
+                        size_t threshold = inline_parse_threshold,
+                        ParseOptions options = {});
+// Maps the file at `path` and parses it in place; the input is never copied
+// onto the heap unless it can't be mapped (e.g. a pipe).
+Document parse_file(const std::string &path,
+                    size_t threshold = inline_parse_threshold,
+                    ParseOptions options = {});
 #endif // READER_HPP
\ No newline at end of file
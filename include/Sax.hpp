@@ -0,0 +1,138 @@
+#ifndef SAX_HPP
+#define SAX_HPP
+#include "Reader.hpp"
+#include "json.hpp"
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Receives a document as a stream of events instead of a Json tree.
+// Strings arrive as views (borrowed from the input or the token); the
+// std::string&& overloads are called for decoded strings the handler may
+// take ownership of, and forward to the view overloads by default.
+struct SaxHandler {
+    SaxHandler() = default;
+    SaxHandler(const SaxHandler &) = default;
+    SaxHandler(SaxHandler &&) = default;
+    SaxHandler &operator=(const SaxHandler &) = default;
+    SaxHandler &operator=(SaxHandler &&) = default;
+    virtual ~SaxHandler() = default;
+
+    virtual void null() = 0;
+    virtual void boolean(bool value) = 0;
+    virtual void number(double value) = 0;
+    // Exact integers; forward to number(double) by default.
+    virtual void int64(int64_t value) { number(static_cast<double>(value)); }
+    virtual void uint64(uint64_t value) {
+        number(static_cast<double>(value));
+    }
+    // Number text under ParseOptions::raw_numbers; converted and forwarded
+    // to the events above by default.
+    virtual void raw_number(std::string_view text);
+    virtual void string(std::string_view value) = 0;
+    virtual void string(std::string &&value) { string(std::string_view(value)); }
+
+    virtual void start_array() = 0;
+    virtual void end_array() = 0;
+    virtual void start_object() = 0;
+    // Returning false rejects the key as a duplicate.
+    virtual bool key(std::string_view value) = 0;
+    virtual bool key(std::string &&value) {
+        return key(std::string_view(value));
+    }
+    virtual void end_object() = 0;
+};
+
+// Checks the token grammar and turns tokens into SaxHandler events. It is
+// fed one token at a time and keeps its own container stack, so it never
+// recurses and can be driven by any token source.
+class SaxParser {
+  public:
+    explicit SaxParser(SaxHandler &handler) : handler(&handler) {}
+
+    // Consumes `token` (strings may be moved out of it). Returns true once
+    // the document, including its EOF token, is complete.
+    bool push(Token &token);
+    // Like push, but malformed input only sets error() and returns true.
+    // The error's offset is left 0: tokens don't carry one, whoever feeds
+    // them knows it (see Parser::try_parse).
+    bool try_push(Token &token);
+    const std::optional<ParseError> &error() const { return error_; }
+
+    size_t depth() const { return containers.size(); }
+
+  private:
+    enum class State {
+        VALUE,        // a value must follow
+        ARRAY_FIRST,  // after `[`: a value or `]`
+        OBJECT_FIRST, // after `{`: a key or `}`
+        KEY,          // after `,` in an object
+        COLON,        // after a key
+        AFTER_VALUE,  // `,`, a closing bracket, or EOF at the top level
+        DONE,
+    };
+    enum class Container : char { ARRAY, OBJECT };
+
+    SaxHandler *handler;
+    State state = State::VALUE;
+    std::vector<Container> containers;
+    std::optional<ParseError> error_;
+
+    // These return what try_push does.
+    bool value(Token &token);
+    bool key(Token &token);
+    bool fail(const Token &token, ParseError::Kind kind);
+};
+
+// The handler behind Parser::parse(): builds a Json, allocating containers
+// from `resource`.
+class DomBuilder : public SaxHandler {
+  public:
+    explicit DomBuilder(std::pmr::memory_resource *resource =
+                            std::pmr::get_default_resource(),
+                        ParseStats *stats = nullptr)
+        : resource(resource), stats(stats) {}
+
+    void null() override;
+    void boolean(bool value) override;
+    void number(double value) override;
+    void int64(int64_t value) override;
+    void uint64(uint64_t value) override;
+    void raw_number(std::string_view text) override;
+    void string(std::string_view value) override;
+    void string(std::string &&value) override;
+    void start_array() override;
+    void end_array() override;
+    void start_object() override;
+    bool key(std::string_view value) override;
+    void end_object() override;
+
+    Json &result() { return root; }
+
+  private:
+    struct Frame {
+        Json container;
+        size_t base;     // first element (or member value) in `elements`
+        size_t key_base; // objects: first key in `keys`
+        // objects above JsonObject::index_threshold: keys seen so far
+        std::unique_ptr<std::unordered_set<const char *>> seen;
+    };
+    std::pmr::memory_resource *resource;
+    ParseStats *stats; // nodes, bytes and depth
+    std::vector<Frame> frames;
+    // Array elements and object members are collected here first so each
+    // container is allocated once at its final size; growing it in place
+    // would strand every outgrown buffer in a monotonic arena.
+    std::vector<Json> elements;
+    std::vector<std::string_view> keys; // interned in `pool`
+    std::unique_ptr<KeyPool, KeyPool::Release> pool;
+    Json root;
+
+    void emit(Json value);
+};
+#endif // SAX_HPP
@@ -0,0 +1,23 @@
+#ifndef SCAN_HPP
+#define SCAN_HPP
+
+// Returns the first character in [begin, end) that ends a clean run inside
+// a JSON string: `"`, `\` or a control character ('\0' ... '\x1F'), which
+// the serializer must escape. Returns `end` if there is none.
+const char *find_string_special(const char *begin, const char *end);
+
+// Returns the first `"`, `[`, `]`, `{` or `}` in [begin, end), or `end`:
+// all that matters to skip over a container without parsing it.
+const char *find_container_special(const char *begin, const char *end);
+
+// The individual implementations, exposed for tests and benchmarks.
+// The functions above dispatch to the best one the CPU supports.
+const char *find_string_special_scalar(const char *begin, const char *end);
+const char *find_container_special_scalar(const char *begin, const char *end);
+#if defined(__x86_64__) || defined(__i386__)
+const char *find_string_special_sse2(const char *begin, const char *end);
+const char *find_string_special_avx2(const char *begin, const char *end);
+const char *find_container_special_sse2(const char *begin, const char *end);
+const char *find_container_special_avx2(const char *begin, const char *end);
+#endif
+#endif // SCAN_HPP
@@ -0,0 +1,67 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Parse statistics are compiled in only with JSON_PARSER_STATS defined
+// (xmake f --stats=y). Otherwise every recording site sits behind
+// `if constexpr (stats_enabled)` and no code is generated for it.
+#ifdef JSON_PARSER_STATS
+constexpr bool stats_enabled = true;
+#else
+constexpr bool stats_enabled = false;
+#endif
+
+struct Json;
+
+// Filled by the Lexer, Parser, DomBuilder, TokenChannel and
+// inline/threaded_parse of one parse (ParseOptions::stats). The lexer
+// thread and the parser thread write disjoint fields.
+struct ParseStats {
+    static constexpr size_t token_types = 12; // Token::Type
+
+    uint64_t bytes_lexed = 0;
+    std::array<uint64_t, token_types> tokens{}; // by Token::Type
+    uint64_t lex_ns = 0;         // inside Lexer::get_next_token
+    uint64_t parse_ns = 0;       // Parser::parse, lexing and waits included
+    uint64_t total_ns = 0;       // the whole inline/threaded_parse call
+    uint64_t lexer_wait_ns = 0;  // lexer blocked on a full TokenChannel
+    uint64_t parser_wait_ns = 0; // parser blocked on an empty one
+    uint64_t nodes = 0;          // values built by DomBuilder
+    uint64_t bytes_allocated = 0; // container storage and owned strings
+    uint64_t max_depth = 0;
+
+    Json to_json() const;
+};
+
+// Adds the time until it goes out of scope to `stats->*counter`; does
+// nothing when `stats` is null or stats are compiled out.
+class StatsTimer {
+  public:
+    StatsTimer(ParseStats *stats, uint64_t ParseStats::*counter) {
+        if constexpr (stats_enabled) {
+            if (stats != nullptr) {
+                target = &(stats->*counter);
+                start = std::chrono::steady_clock::now();
+            }
+        }
+    }
+    StatsTimer(const StatsTimer &) = delete;
+    StatsTimer &operator=(const StatsTimer &) = delete;
+    ~StatsTimer() {
+        if constexpr (stats_enabled) {
+            if (target != nullptr) {
+                *target += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+            }
+        }
+    }
+
+  private:
+    uint64_t *target = nullptr;
+    std::chrono::steady_clock::time_point start;
+};
+#endif // STATS_HPP
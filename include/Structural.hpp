@@ -0,0 +1,19 @@
+#ifndef STRUCTURAL_HPP
+#define STRUCTURAL_HPP
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Byte offsets of every token start in a document: structural characters
+// outside strings, opening quotes, and the first character of each number
+// or literal. Built 64 bytes at a time from SIMD bitmasks (stage 1), so the
+// lexer can jump from token to token instead of walking the bytes between
+// them (stage 2, see indexed_parse in Reader.hpp).
+using StructuralIndex = std::vector<uint32_t>;
+
+// Documents must be smaller than 4 GiB so offsets fit in 32 bits.
+StructuralIndex build_structural_index(std::string_view data);
+
+// Same result without SIMD, exposed for tests and benchmarks.
+StructuralIndex build_structural_index_scalar(std::string_view data);
+#endif // STRUCTURAL_HPP
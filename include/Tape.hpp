@@ -0,0 +1,262 @@
+#ifndef TAPE_HPP
+#define TAPE_HPP
+#include "Reader.hpp"
+#include "Sax.hpp"
+#include "json.hpp"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class TapeValue;
+
+// An immutable document in two flat buffers instead of a tree of Json
+// nodes: a tape of 64-bit words, one per value in document order, and the
+// string bytes next to it. Each word keeps its tag in the top byte and a
+// 56-bit payload:
+//
+//   n t f        null, true, false
+//   l u d        int64, uint64, double; the next word holds the bits
+//   "            string: offset in `strings` of a 4-byte length and bytes
+//   [ {          start: index past the matching end word (low 32 bits),
+//                elements or members (next 24 bits, saturated)
+//   ] }          end: index of the start word
+//
+// Object members are a string word for the key and then the value. Since
+// every container knows where it ends, skipping one is a single load.
+class Tape {
+  public:
+    enum class Tag : char {
+        NULL_ = 'n',
+        TRUE = 't',
+        FALSE = 'f',
+        INT64 = 'l',
+        UINT64 = 'u',
+        DOUBLE = 'd',
+        STRING = '"',
+        BEGIN_ARRAY = '[',
+        END_ARRAY = ']',
+        BEGIN_OBJECT = '{',
+        END_OBJECT = '}',
+    };
+    static constexpr uint64_t payload_mask = (uint64_t{1} << 56) - 1;
+    static constexpr uint64_t count_limit = (uint64_t{1} << 24) - 1;
+
+    static uint64_t word(Tag tag, uint64_t payload) {
+        return (static_cast<uint64_t>(tag) << 56) | payload;
+    }
+    Tag tag(size_t index) const {
+        return static_cast<Tag>(words[index] >> 56);
+    }
+    uint64_t payload(size_t index) const {
+        return words[index] & payload_mask;
+    }
+    // The bits of the number starting at `index`.
+    uint64_t next_word(size_t index) const { return words[index + 1]; }
+    std::string_view string(size_t index) const {
+        return string_at(payload(index));
+    }
+    // The string stored at `offset` in the string buffer.
+    std::string_view string_at(uint64_t offset) const;
+    // The word after the value starting at `index`.
+    size_t skip(size_t index) const;
+
+    TapeValue root() const;
+
+    // Same output as Json::dump of the same document.
+    std::string dump(int size = 4) const;
+    void dump_to(std::string &out, int size = 4) const;
+
+    // Footprint of the two buffers, for comparison with a Json tree.
+    size_t tape_size() const { return words.size(); }
+    size_t string_bytes() const { return strings.size(); }
+
+  private:
+    friend class TapeBuilder;
+    std::vector<uint64_t> words;
+    std::vector<char> strings;
+};
+
+// A cursor on a Tape: the index of a value's first word. Cheap to copy;
+// the Tape must outlive it.
+class TapeValue {
+  public:
+    TapeValue(const Tape &tape, size_t index) : tape(&tape), index(index) {}
+
+    Json::Type get_type() const;
+    bool is_null() const { return tape->tag(index) == Tape::Tag::NULL_; }
+    // bool, double, int64_t, uint64_t or std::string_view; throws
+    // std::logic_error on the wrong type, like Json::as.
+    template <class T> T as() const;
+
+    // Elements of an array or members of an object.
+    size_t size() const;
+
+    // Object member / array element, or std::nullopt if there is none.
+    // Throw std::logic_error on the wrong type, like Json::operator[].
+    std::optional<TapeValue> find(std::string_view key) const;
+    std::optional<TapeValue> find(size_t index) const;
+    // Like find, but throw std::out_of_range when missing.
+    TapeValue operator[](std::string_view key) const;
+    TapeValue operator[](size_t index) const;
+
+    // Iterates array elements or object member values; key() gives the
+    // member's key.
+    class Iterator {
+      public:
+        using value_type = TapeValue;
+        using difference_type = std::ptrdiff_t;
+        using reference = TapeValue;
+        using pointer = void;
+        using iterator_category = std::forward_iterator_tag;
+
+        Iterator() = default;
+        TapeValue operator*() const {
+            return {*tape, object ? index + 1 : index};
+        }
+        Iterator &operator++() {
+            index = tape->skip(object ? index + 1 : index);
+            return *this;
+        }
+        Iterator operator++(int) {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const Iterator &rhs) const {
+            return index == rhs.index;
+        }
+        std::string_view key() const { return tape->string(index); }
+
+      private:
+        friend class TapeValue;
+        Iterator(const Tape &tape, size_t index, bool object)
+            : tape(&tape), index(index), object(object) {}
+        const Tape *tape = nullptr;
+        size_t index = 0; // objects: the member's key
+        bool object = false;
+    };
+    Iterator begin() const;
+    Iterator end() const;
+
+    std::string dump(int size = 4) const;
+    void dump_to(std::string &out, int size = 4) const;
+
+  private:
+    const Tape *tape;
+    size_t index;
+
+    void expect_container() const;
+};
+
+inline TapeValue Tape::root() const { return {*this, 0}; }
+
+template <class T> T TapeValue::as() const {
+    using Tag = Tape::Tag;
+    switch (tape->tag(index)) {
+    case Tag::TRUE:
+    case Tag::FALSE:
+        if constexpr (std::is_same_v<T, bool>) {
+            return tape->tag(index) == Tag::TRUE;
+        }
+        break;
+    case Tag::DOUBLE:
+        if constexpr (std::is_same_v<T, double>) {
+            return std::bit_cast<double>(tape->next_word(index));
+        }
+        break;
+    case Tag::INT64: {
+        auto i = static_cast<int64_t>(tape->next_word(index));
+        if constexpr (std::is_same_v<T, double>) {
+            return static_cast<double>(i);
+        } else if constexpr (std::is_same_v<T, int64_t> ||
+                             std::is_same_v<T, uint64_t>) {
+            if (std::in_range<T>(i)) {
+                return static_cast<T>(i);
+            }
+        }
+        break;
+    }
+    case Tag::UINT64: {
+        auto bits = tape->next_word(index);
+        if constexpr (std::is_same_v<T, double>) {
+            return static_cast<double>(bits);
+        } else if constexpr (std::is_same_v<T, int64_t> ||
+                             std::is_same_v<T, uint64_t>) {
+            if (std::in_range<T>(bits)) {
+                return static_cast<T>(bits);
+            }
+        }
+        break;
+    }
+    case Tag::STRING:
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            return tape->string(index);
+        }
+        break;
+    default:
+        break;
+    }
+    throw std::logic_error("as : type incorrect");
+}
+
+// The handler behind Parser::parse_tape(): appends each event to a Tape,
+// rejecting duplicate keys like DomBuilder.
+class TapeBuilder : public SaxHandler {
+  public:
+    void null() override;
+    void boolean(bool value) override;
+    void number(double value) override;
+    void int64(int64_t value) override;
+    void uint64(uint64_t value) override;
+    void string(std::string_view value) override;
+    void start_array() override;
+    void end_array() override;
+    void start_object() override;
+    bool key(std::string_view value) override;
+    void end_object() override;
+
+    Tape &result() { return tape; }
+
+  private:
+    // Keys are compared through their offsets in tape.strings, which stay
+    // valid while the buffer grows.
+    struct KeyHash {
+        const Tape *tape;
+        size_t operator()(uint64_t offset) const;
+    };
+    struct KeyEqual {
+        const Tape *tape;
+        bool operator()(uint64_t lhs, uint64_t rhs) const;
+    };
+    using KeySet = std::unordered_set<uint64_t, KeyHash, KeyEqual>;
+    struct Frame {
+        size_t start;    // index of the start word
+        uint64_t count;  // elements or members so far
+        size_t key_base; // objects: first key in `keys`
+        // objects above JsonObject::index_threshold: keys seen so far
+        std::unique_ptr<KeySet> seen;
+    };
+    Tape tape;
+    std::vector<Frame> frames;
+    std::vector<uint64_t> keys; // string offsets of the open objects' keys
+
+    uint64_t append_string(std::string_view value);
+    void scalar(Tape::Tag tag, uint64_t bits);
+    void start(Tape::Tag tag);
+    void end(Tape::Tag tag);
+};
+
+// Parses `data` into a Tape on the calling thread.
+Tape tape_parse(std::string_view data, ParseOptions options = {});
+#endif // TAPE_HPP
@@ -0,0 +1,106 @@
+#ifndef WORKERPOOL_HPP
+#define WORKERPOOL_HPP
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <latch>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads kept alive for the whole process so that parse calls
+// never pay for thread creation.
+class WorkerPool {
+  public:
+    explicit WorkerPool(size_t threads);
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+    ~WorkerPool();
+
+    // Hands `task` to an idle worker. Returns false without queueing when
+    // every worker is busy, so callers can do the work themselves instead of
+    // waiting behind (or deadlocking on) other tasks.
+    bool try_run(std::function<void()> task);
+    // Queues `task` for the next free worker.
+    void run(std::function<void()> task);
+
+    // Calls body(i) for every i in [0, count) on all workers plus the calling
+    // thread, and returns when all calls are done. Each participant starts
+    // on its own contiguous slice of the indices; one that runs dry steals
+    // the back half of another's remaining slice. `body` must not throw.
+    template <class Body> void parallel_for(size_t count, Body &&body);
+
+    size_t size() const { return workers.size(); }
+
+    static WorkerPool &instance();
+
+  private:
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+    size_t idle = 0;
+    bool stop = false;
+
+    void work();
+};
+
+template <class Body> void WorkerPool::parallel_for(size_t count, Body &&body) {
+    struct alignas(64) Slice {
+        std::mutex m;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+    const size_t participants = workers.size() + 1;
+    std::vector<Slice> slices(participants);
+    for (size_t p = 0; p < participants; ++p) {
+        slices[p].begin = count * p / participants;
+        slices[p].end = count * (p + 1) / participants;
+    }
+    auto take = [&](size_t self, size_t &index) {
+        {
+            std::unique_lock<std::mutex> lk(slices[self].m);
+            if (slices[self].begin != slices[self].end) {
+                index = slices[self].begin++;
+                return true;
+            }
+        }
+        for (size_t k = 1; k < participants; ++k) {
+            auto &victim = slices[(self + k) % participants];
+            size_t begin = 0;
+            size_t end = 0;
+            {
+                std::unique_lock<std::mutex> lk(victim.m);
+                if (victim.begin == victim.end) {
+                    continue;
+                }
+                begin = victim.begin + (victim.end - victim.begin) / 2;
+                end = victim.end;
+                victim.end = begin;
+            }
+            std::unique_lock<std::mutex> lk(slices[self].m);
+            index = begin;
+            slices[self].begin = begin + 1;
+            slices[self].end = end;
+            return true;
+        }
+        return false;
+    };
+    std::latch done(static_cast<std::ptrdiff_t>(participants - 1));
+    auto participate = [&](size_t self) {
+        size_t index = 0;
+        while (take(self, index)) {
+            body(index);
+        }
+    };
+    for (size_t p = 1; p < participants; ++p) {
+        run([&participate, &done, p]() {
+            participate(p);
+            done.count_down();
+        });
+    }
+    participate(0);
+    done.wait();
+}
+#endif // WORKERPOOL_HPP
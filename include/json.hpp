@@ -1,11 +1,18 @@
 #ifndef JSON_HPP
 #define JSON_HPP
 
-#include <map>
+#include "KeyPool.hpp"
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory_resource>
 #include <stdexcept>
 #include <string>
-#include <unordered_map>
-#include <variant>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 struct Null {
     friend bool operator==(const Null & /*unused*/, const Null & /*unused*/) {
@@ -14,28 +21,184 @@ struct Null {
 };
 struct ArrayType {};
 struct ObjectType {};
+struct StringType {};
+// Tag for a string the Json only points to; see Json(BorrowedString, ...).
+struct BorrowedString {};
+// Validated number text from the input (ParseOptions::raw_numbers); it is
+// converted only when read through Json::as and dumped as is.
+struct RawNumber {
+    std::string_view text;
+    friend bool operator==(const RawNumber &lhs, const RawNumber &rhs) {
+        return lhs.text == rhs.text;
+    }
+};
+struct Json;
+
+// Json::objecttype: members in insertion order in one flat array, keys
+// interned in a KeyPool shared with the rest of the document. Small
+// objects are searched linearly; above index_threshold members an open
+// addressing index on the interned key pointers is kept behind the
+// array, in the same allocation. Like the pmr containers, a copy
+// allocates from the default resource and assignment keeps the target's.
+class JsonObject {
+  public:
+    struct Entry;
+    constexpr static size_t index_threshold = 32;
+
+    explicit JsonObject(std::pmr::memory_resource *resource =
+                            std::pmr::get_default_resource()) noexcept
+        : resource(resource) {}
+    JsonObject(const JsonObject &other);
+    JsonObject(JsonObject &&other) noexcept;
+    JsonObject &operator=(const JsonObject &other);
+    JsonObject &operator=(JsonObject &&other);
+    ~JsonObject();
+
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] bool empty() const { return count == 0; }
+    Entry *begin() { return entries; }
+    Entry *end();
+    const Entry *begin() const { return entries; }
+    const Entry *end() const;
+    [[nodiscard]] std::pmr::polymorphic_allocator<Entry> get_allocator() const {
+        return resource;
+    }
+    [[nodiscard]] KeyPool *key_pool() const { return pool; }
+    // Size of the one allocation holding the members and the index.
+    [[nodiscard]] size_t allocated_bytes() const;
+
+    Json *find(std::string_view key);
+    const Json *find(std::string_view key) const;
+    bool contains(std::string_view key) const { return find(key) != nullptr; }
+    // Throws std::out_of_range when `key` is missing.
+    Json &at(std::string_view key);
+    const Json &at(std::string_view key) const;
+    // The value for `key`, inserted as null at the end if missing.
+    Json &operator[](std::string_view key);
+    // Adds a member built from `args` at the end unless `key` is there.
+    template <class... Args>
+    std::pair<Json *, bool> try_emplace(std::string_view key, Args &&...args);
+
+    // For parsers: replaces the contents with `size` members whose keys
+    // were interned from `pool` and are distinct. Values are moved from.
+    void assign(KeyPool *pool, const std::string_view *keys, Json *values,
+                size_t size);
+
+    // Same members regardless of order.
+    friend bool operator==(const JsonObject &lhs, const JsonObject &rhs);
+
+  private:
+    Entry *entries = nullptr;
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+    std::pmr::memory_resource *resource;
+    KeyPool *pool = nullptr;
+
+    void swap(JsonObject &other) noexcept;
+    // Appends a member for a key known to be missing.
+    Json *add(std::string_view key, Json &&value);
+    uint32_t *index() const;
+    void reserve(size_t size);
+    void rebuild_index();
+    void insert_index(size_t position);
+    void clear();
+    void copy_from(const JsonObject &other);
+    void set_pool(KeyPool *other);
+};
 struct Json {
-    using arraytype = std::map<size_t, Json>;
-    using objecttype = std::unordered_map<std::string, Json>;
-    std::variant<Null, bool, double, std::string, arraytype, objecttype> data;
+    // Containers allocate from a memory_resource so a parser can put a
+    // whole document into one arena (see Document in Reader.hpp).
+    using arraytype = std::pmr::vector<Json>;
+    using objecttype = JsonObject;
 
-    template <class T> explicit Json(T b) : data(b) {}
+    // Null. The other constructors take one alternative each: integers are
+    // kept exactly as int64_t (uint64_t for unsigned types), strings are
+    // copied, and RawNumber text is borrowed from the parser input.
     Json() = default;
-    void append(Json json);
+    explicit Json(Null /*unused*/) {}
+    template <std::integral T> explicit Json(T value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            storage.large = {Kind::BOOL_, 0, {.boolean = value}};
+        } else if constexpr (std::is_signed_v<T>) {
+            storage.large = {Kind::INT64, 0, {.int64 = value}};
+        } else {
+            storage.large = {Kind::UINT64, 0, {.uint64 = value}};
+        }
+    }
+    explicit Json(double value) {
+        storage.large = {Kind::DOUBLE, 0, {.number = value}};
+    }
+    explicit Json(std::string_view value) : Json(StringType{}, value) {}
+    explicit Json(const char *value) : Json(StringType{}, value) {}
+    explicit Json(RawNumber value)
+        : Json(Kind::RAW_NUMBER, value.text.data(), value.text.size()) {}
+    explicit Json(const std::string &value) : Json(StringType{}, value) {}
+    // An owned copy of `value`; strings longer than small_capacity are
+    // allocated from `resource`.
+    Json(StringType /**/, std::string_view value,
+         std::pmr::memory_resource *resource =
+             std::pmr::get_default_resource());
+    // Points to `value` without copying it, which must outlive the Json:
+    // for parsers borrowing from their input (ParseOptions::borrow_strings).
+    Json(BorrowedString /**/, std::string_view value)
+        : Json(Kind::VIEW, value.data(), value.size()) {}
+    explicit Json(arraytype value);
+    explicit Json(objecttype value);
+    explicit Json(ArrayType /**/, std::pmr::memory_resource *resource =
+                                      std::pmr::get_default_resource());
+    explicit Json(ObjectType /**/, std::pmr::memory_resource *resource =
+                                       std::pmr::get_default_resource());
+
+    // Like the pmr containers, a copy allocates from the default resource.
+    // A move takes the source's allocations and leaves it null.
+    Json(const Json &other);
+    Json(Json &&other) noexcept : storage(other.storage) {
+        other.storage.large = {};
+    }
+    Json &operator=(const Json &other);
+    Json &operator=(Json &&other) noexcept;
+    ~Json() {
+        if (kind() >= Kind::STRING) {
+            release();
+        }
+    }
+
+    // Arrays: add an element at the end and return it. A moved-in value
+    // keeps its allocations; a copied one allocates from the default
+    // resource, like the copy constructor.
+    Json &append(Json &&value);
+    Json &append(const Json &value);
+    template <class... Args> Json &emplace_back(Args &&...args);
     Json &operator[](size_t index);
     const Json &operator[](size_t index) const;
 
-    Json &operator[](std::string index);
-    const Json &operator[](std::string index) const;
+    // Objects: keys are looked up as views, without building a string.
+    Json &operator[](std::string_view key);
+    const Json &operator[](std::string_view key) const;
+    // The member's value, or nullptr if there is none.
+    Json *find(std::string_view key);
+    const Json *find(std::string_view key) const;
+    // Like std::map::try_emplace / insert: add the member unless `key` is
+    // already there, and return its value and whether it was added.
+    template <class... Args>
+    std::pair<Json *, bool> emplace(std::string_view key, Args &&...args);
+    std::pair<Json *, bool> insert(std::string_view key, Json &&value) {
+        return emplace(key, std::move(value));
+    }
+    std::pair<Json *, bool> insert(std::string_view key, const Json &value) {
+        return emplace(key, value);
+    }
 
     bool contains(size_t index) const;
-    bool contains(std::string index) const;
+    bool contains(std::string_view key) const;
     std::string dump(int size = 4) const { return dump(size, 0); }
     std::string dump(int size, size_t level) const;
+    // Serialize without building a string per node: append to `out`, or
+    // stream to `os` / `fd` through one reused 64 KiB buffer.
+    void dump_to(std::string &out, int size = 4) const;
+    void dump_to(std::ostream &os, int size = 4) const;
+    void dump_to(int fd, int size = 4) const;
 
-    friend bool operator==(const Json &lhs, const Json &rhs) {
-        return lhs.data == rhs.data;
-    }
     enum class Type {
         NULL_,
         BOOL_,
@@ -45,14 +208,231 @@ struct Json {
         OBJECT,
     };
 
-    Type get_type() const { return static_cast<Type>(data.index()); }
-    template <class T> const T &as() const {
-        if (!std::holds_alternative<T>(data)) {
+    Type get_type() const {
+        constexpr Type types[] = {
+            Type::NULL_,  Type::BOOL_,  Type::NUMBER, Type::NUMBER,
+            Type::NUMBER, Type::NUMBER, Type::STRING, Type::STRING,
+            Type::STRING, Type::ARRAY,  Type::OBJECT,
+        };
+        return types[static_cast<size_t>(kind())]; // NOLINT
+    }
+    // Which representation holds the value: Null, bool, double, int64_t,
+    // uint64_t, RawNumber, std::string_view (borrowed), std::string
+    // (owned), arraytype or objecttype.
+    template <class T> bool is() const;
+    // The value if is<T>(), otherwise nullptr; for the alternatives stored
+    // as themselves (bool, the numbers, arraytype and objecttype).
+    template <class T> const T *get_if() const;
+    template <class T> T *get_if() {
+        return const_cast<T *>(std::as_const(*this).get_if<T>());
+    }
+    // Converts number text the way the lexer does: int64_t, uint64_t if too
+    // big for that, otherwise double.
+    static Json parse_number(std::string_view text);
+    // as<std::string_view>() works for both owned and borrowed strings, as
+    // does as<std::string>(), which copies.
+    // as<double>() works for every number (integers above 2^53 round);
+    // as<int64_t>() and as<uint64_t>() only for integers that fit exactly.
+    template <class T> decltype(auto) as() const;
+    friend bool operator==(const Json &lhs, const Json &rhs);
+
+    // Strings up to this many bytes are stored in the node itself.
+    constexpr static size_t small_capacity = 14;
+
+  private:
+    // The order matters: kinds from STRING on own an allocation.
+    enum class Kind : uint8_t {
+        NULL_,
+        BOOL_,
+        DOUBLE,
+        INT64,
+        UINT64,
+        RAW_NUMBER,
+        VIEW,
+        SMALL_STRING,
+        STRING,
+        ARRAY,
+        OBJECT,
+    };
+    union Value {
+        bool boolean;
+        double number;
+        int64_t int64;
+        uint64_t uint64;
+        // RAW_NUMBER, VIEW and STRING; a STRING's bytes follow the
+        // memory_resource* they were allocated from
+        const char *text;
+        arraytype *array;
+        objecttype *object;
+    };
+    // Both layouts start with the kind, so it can be read through either.
+    struct Large {
+        Kind kind = Kind::NULL_;
+        uint32_t length = 0; // of `text`
+        Value value{.uint64 = 0};
+    };
+    struct Small {
+        Kind kind;
+        uint8_t size;
+        char chars[small_capacity];
+    };
+    union Storage {
+        Large large;
+        Small small;
+    };
+    Storage storage{.large = {}};
+
+    Json(Kind kind, const char *text, size_t length);
+    Kind kind() const { return storage.large.kind; }
+    std::string_view text() const {
+        if (kind() == Kind::SMALL_STRING) {
+            return {storage.small.chars, storage.small.size};
+        }
+        return {storage.large.value.text, storage.large.length};
+    }
+    void release() noexcept;
+    // The container, or throws std::logic_error(message).
+    arraytype &expect_array(const char *message);
+    objecttype &expect_object(const char *message);
+    // Compares numbers stored in different representations by value.
+    static bool numbers_equal(const Json &lhs, const Json &rhs);
+};
+static_assert(sizeof(Json) == 16);
+
+template <class T> bool Json::is() const {
+    if constexpr (std::is_same_v<T, Null>) {
+        return kind() == Kind::NULL_;
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return kind() == Kind::BOOL_;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return kind() == Kind::DOUBLE;
+    } else if constexpr (std::is_same_v<T, int64_t>) {
+        return kind() == Kind::INT64;
+    } else if constexpr (std::is_same_v<T, uint64_t>) {
+        return kind() == Kind::UINT64;
+    } else if constexpr (std::is_same_v<T, RawNumber>) {
+        return kind() == Kind::RAW_NUMBER;
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+        return kind() == Kind::VIEW;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return kind() == Kind::SMALL_STRING || kind() == Kind::STRING;
+    } else if constexpr (std::is_same_v<T, arraytype>) {
+        return kind() == Kind::ARRAY;
+    } else {
+        static_assert(std::is_same_v<T, objecttype>, "not a Json alternative");
+        return kind() == Kind::OBJECT;
+    }
+}
+
+template <class T> const T *Json::get_if() const {
+    if (!is<T>()) {
+        return nullptr;
+    }
+    const auto &value = storage.large.value;
+    if constexpr (std::is_same_v<T, bool>) {
+        return &value.boolean;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return &value.number;
+    } else if constexpr (std::is_same_v<T, int64_t>) {
+        return &value.int64;
+    } else if constexpr (std::is_same_v<T, uint64_t>) {
+        return &value.uint64;
+    } else if constexpr (std::is_same_v<T, arraytype>) {
+        return value.array;
+    } else {
+        static_assert(std::is_same_v<T, objecttype>,
+                      "only alternatives stored as themselves");
+        return value.object;
+    }
+}
+
+template <class T> decltype(auto) Json::as() const {
+    const auto &value = storage.large.value;
+    if constexpr (std::is_same_v<T, double>) {
+        switch (kind()) {
+        case Kind::DOUBLE:
+            return value.number;
+        case Kind::INT64:
+            return static_cast<double>(value.int64);
+        case Kind::UINT64:
+            return static_cast<double>(value.uint64);
+        case Kind::RAW_NUMBER:
+            return parse_number(text()).as<double>();
+        default:
             throw std::logic_error("as : type incorrect");
         }
-        return std::get<T>(data);
+    } else if constexpr (std::is_same_v<T, int64_t> ||
+                         std::is_same_v<T, uint64_t>) {
+        if (kind() == Kind::INT64 && std::in_range<T>(value.int64)) {
+            return static_cast<T>(value.int64);
+        }
+        if (kind() == Kind::UINT64 && std::in_range<T>(value.uint64)) {
+            return static_cast<T>(value.uint64);
+        }
+        if (kind() == Kind::RAW_NUMBER) {
+            return parse_number(text()).as<T>();
+        }
+        throw std::logic_error("as : type incorrect");
+    } else if constexpr (std::is_same_v<T, std::string_view> ||
+                         std::is_same_v<T, std::string>) {
+        if (get_type() != Type::STRING) {
+            throw std::logic_error("as : type incorrect");
+        }
+        return T(text());
+    } else if constexpr (std::is_same_v<T, RawNumber>) {
+        if (kind() != Kind::RAW_NUMBER) {
+            throw std::logic_error("as : type incorrect");
+        }
+        return RawNumber{text()};
+    } else if constexpr (std::is_same_v<T, Null>) {
+        if (kind() != Kind::NULL_) {
+            throw std::logic_error("as : type incorrect");
+        }
+        return Null{};
+    } else {
+        const auto *held = get_if<T>();
+        if (held == nullptr) {
+            throw std::logic_error("as : type incorrect");
+        }
+        return static_cast<const T &>(*held);
     }
+}
+struct JsonObject::Entry {
+    std::string_view key; // interned in the object's KeyPool
+    Json value;
 };
-template <> Json::Json(ArrayType);
-template <> Json::Json(ObjectType);
+
+template <class... Args>
+std::pair<Json *, bool> JsonObject::try_emplace(std::string_view key,
+                                                Args &&...args) {
+    if (auto *value = find(key)) {
+        return {value, false};
+    }
+    // built before the members can move: `args` may refer to one of them
+    return {add(key, Json(std::forward<Args>(args)...)), true};
+}
+inline Json &JsonObject::operator[](std::string_view key) {
+    return *try_emplace(key).first;
+}
+
+template <class... Args> Json &Json::emplace_back(Args &&...args) {
+    return expect_array("only array can append")
+        .emplace_back(std::forward<Args>(args)...);
+}
+template <class... Args>
+std::pair<Json *, bool> Json::emplace(std::string_view key, Args &&...args) {
+    return expect_object("only object can use string index")
+        .try_emplace(key, std::forward<Args>(args)...);
+}
+inline JsonObject::Entry *JsonObject::end() { return entries + count; }
+
+// The scalars exactly as Json::dump writes them, for other serializers:
+// a quoted and escaped string, and the shortest form of a double.
+void dump_string_to(std::string &out, std::string_view string);
+void dump_number_to(std::string &out, double number);
+// Writes all of `data` to `fd`; throws std::runtime_error on failure.
+void dump_write(int fd, std::string_view data);
+inline const JsonObject::Entry *JsonObject::end() const {
+    return entries + count;
+}
 #endif // JSON_HPP
\ No newline at end of file
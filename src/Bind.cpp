@@ -0,0 +1,198 @@
+#include "Bind.hpp"
+#include "Sax.hpp"
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+// Validates a value that no field asked for, duplicate keys included.
+struct IgnoreHandler : SaxHandler {
+    // keys of each open object
+    std::vector<std::unordered_set<std::string>> objects;
+
+    void null() override {}
+    void boolean(bool /*value*/) override {}
+    void number(double /*value*/) override {}
+    void string(std::string_view /*value*/) override {}
+    void start_array() override {}
+    void end_array() override {}
+    void start_object() override { objects.emplace_back(); }
+    bool key(std::string_view value) override {
+        return objects.back().emplace(value).second;
+    }
+    bool key(std::string &&value) override {
+        return objects.back().insert(std::move(value)).second;
+    }
+    void end_object() override { objects.pop_back(); }
+};
+
+// The number in a NUMBER token as a Json (int64_t, uint64_t or double),
+// also for raw number text.
+Json number_of(const Token &token) {
+    if (const auto *text = std::get_if<std::string_view>(&token.value)) {
+        return Json::parse_number(*text);
+    }
+    if (const auto *i = std::get_if<int64_t>(&token.value)) {
+        return Json(*i);
+    }
+    if (const auto *u = std::get_if<uint64_t>(&token.value)) {
+        return Json(*u);
+    }
+    return Json(std::get<double>(token.value));
+}
+} // namespace
+
+void StructReader::error(const Token &token, const char *messgae) {
+    std::string message_ = std::to_string(token.lineno) + ":" +
+                           std::to_string(token.col_offset) + ": " + messgae;
+    throw std::runtime_error(message_);
+}
+
+void StructReader::finish() {
+    if (token.type != Token::Type::EOF_) {
+        error(token, "End of file expected");
+    }
+}
+
+void StructReader::expect(Token::Type type, const char *messgae) {
+    if (token.type != type) {
+        error(token, messgae);
+    }
+    advance();
+}
+
+bool StructReader::close(Token::Type end) {
+    if (token.type != end) {
+        return false;
+    }
+    advance();
+    return true;
+}
+
+bool StructReader::separator(Token::Type end) {
+    if (token.type == Token::Type::VALUE_SEPARATOR) {
+        advance();
+        return true;
+    }
+    if (token.type == end) {
+        advance();
+        return false;
+    }
+    error(token, "Expected comma or closing bracket");
+}
+
+std::string_view StructReader::read_key() {
+    if (token.type != Token::Type::STRING) {
+        error(token, "Property expected");
+    }
+    key = std::move(token);
+    advance();
+    expect(Token::Type::NAME_SEPARATOR, "Colon expected");
+    if (const auto *view = std::get_if<std::string_view>(&key.value)) {
+        return *view;
+    }
+    return std::get<std::string>(key.value);
+}
+
+void StructReader::read_bool(bool &value) {
+    if (token.type != Token::Type::TRUE && token.type != Token::Type::FALSE) {
+        error(token, "Boolean expected");
+    }
+    value = token.type == Token::Type::TRUE;
+    advance();
+}
+
+int64_t StructReader::read_integer(int64_t min, int64_t max) {
+    if (token.type != Token::Type::NUMBER) {
+        error(token, "Integer expected");
+    }
+    auto number = number_of(token);
+    if (number.is<double>()) {
+        error(token, "Integer expected");
+    }
+    const auto *i = number.get_if<int64_t>();
+    if (i == nullptr || *i < min || *i > max) {
+        error(token, "Integer out of range");
+    }
+    advance();
+    return *i;
+}
+
+uint64_t StructReader::read_unsigned(uint64_t max) {
+    if (token.type != Token::Type::NUMBER) {
+        error(token, "Integer expected");
+    }
+    auto number = number_of(token);
+    if (number.is<double>()) {
+        error(token, "Integer expected");
+    }
+    uint64_t value = 0;
+    if (const auto *i = number.get_if<int64_t>()) {
+        if (*i < 0) {
+            error(token, "Integer out of range");
+        }
+        value = static_cast<uint64_t>(*i);
+    } else {
+        value = *number.get_if<uint64_t>();
+    }
+    if (value > max) {
+        error(token, "Integer out of range");
+    }
+    advance();
+    return value;
+}
+
+double StructReader::read_double() {
+    if (token.type != Token::Type::NUMBER) {
+        error(token, "Number expected");
+    }
+    auto value = number_of(token).as<double>();
+    advance();
+    return value;
+}
+
+void StructReader::read_string(std::string &value) {
+    if (token.type != Token::Type::STRING) {
+        error(token, "String expected");
+    }
+    if (auto *owned = std::get_if<std::string>(&token.value)) {
+        value = std::move(*owned);
+    } else {
+        value = std::get<std::string_view>(token.value);
+    }
+    advance();
+}
+
+void StructReader::read_json(Json &value) {
+    DomBuilder builder;
+    consume(builder);
+    value = std::move(builder.result());
+}
+
+void StructReader::skip() {
+    IgnoreHandler handler;
+    consume(handler);
+}
+
+void StructReader::skip_unknown(std::string_view name,
+                                std::unordered_set<std::string> &unknown) {
+    if (!unknown.emplace(name).second) {
+        error(key, "Duplicate object key");
+    }
+    skip();
+}
+
+// SaxParser checks the grammar; it is handed one value and then an EOF of
+// its own, since the real next token belongs to the enclosing container.
+void StructReader::consume(SaxHandler &handler) {
+    SaxParser sax(handler);
+    do {
+        sax.push(token);
+        advance();
+    } while (sax.depth() != 0);
+    Token eof{token.lineno, token.col_offset, Token::Type::EOF_};
+    sax.push(eof);
+}
@@ -0,0 +1,90 @@
+#include "Incremental.hpp"
+#include "Scan.hpp"
+
+// Scans buffer[from, end) and returns the length of the longest prefix of
+// `buffer` that ends on a token boundary (whitespace or a structural
+// character outside a string), or 0 if the new bytes contain none. Every
+// token in that prefix is complete.
+size_t IncrementalParser::scan(std::string_view buffer, size_t from) {
+    size_t safe = 0;
+    const auto *begin = buffer.data();
+    const auto *end = buffer.data() + buffer.size();
+    const auto *p = begin + from;
+    while (p != end) {
+        if (in_string) {
+            if (escaped) {
+                escaped = false;
+                ++p;
+                continue;
+            }
+            p = find_string_special(p, end);
+            if (p == end) {
+                break;
+            }
+            if (*p == '\x5C') {
+                escaped = true;
+            } else if (*p == '\x22') {
+                in_string = false;
+            }
+            ++p;
+            continue;
+        }
+        switch (*p) {
+        case '\x22':
+            in_string = true;
+            break;
+        case '\x20':
+        case '\x09':
+        case '\x0A':
+        case '\x0D':
+        case '[':
+        case ']':
+        case '{':
+        case '}':
+        case ':':
+        case ',':
+            safe = p - begin + 1;
+            break;
+        default:
+            break;
+        }
+        ++p;
+    }
+    return safe;
+}
+
+void IncrementalParser::lex(std::string_view data, bool last) {
+    Lexer lexer(data, lineno, colnom, options);
+    auto token = lexer.get_next_token();
+    while (token.type != Token::Type::EOF_) {
+        sax.push(token);
+        token = lexer.get_next_token();
+    }
+    lineno = lexer.line();
+    colnom = lexer.column();
+    if (last) {
+        sax.push(token);
+    }
+}
+
+void IncrementalParser::feed(std::string_view chunk) {
+    if (pending.empty()) {
+        // common case: lex straight from the chunk, copy only its tail
+        auto safe = scan(chunk, 0);
+        lex(chunk.substr(0, safe), false);
+        pending.assign(chunk.substr(safe));
+        return;
+    }
+    auto from = pending.size();
+    pending.append(chunk);
+    auto safe = scan(pending, from);
+    if (safe != 0) {
+        lex(std::string_view(pending).substr(0, safe), false);
+        pending.erase(0, safe);
+    }
+}
+
+void IncrementalParser::finish() {
+    lex(pending, true);
+    pending.clear();
+}
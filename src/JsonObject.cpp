@@ -0,0 +1,257 @@
+#include "json.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+size_t table_size(size_t capacity) { return std::bit_ceil(capacity * 2); }
+size_t allocation_size(size_t capacity) {
+    auto size = capacity * sizeof(JsonObject::Entry);
+    if (capacity > JsonObject::index_threshold) {
+        size += table_size(capacity) * sizeof(uint32_t);
+    }
+    return size;
+}
+size_t slot_of(const char *key, size_t mask) {
+    constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ULL; // NOLINT
+    return static_cast<size_t>(
+               (reinterpret_cast<uintptr_t>(key) * multiplier) >> 32) & // NOLINT
+           mask;
+}
+} // namespace
+
+JsonObject::JsonObject(const JsonObject &other)
+    : resource(std::pmr::get_default_resource()) {
+    copy_from(other);
+}
+JsonObject::JsonObject(JsonObject &&other) noexcept
+    : entries(std::exchange(other.entries, nullptr)),
+      count(std::exchange(other.count, 0)),
+      capacity(std::exchange(other.capacity, 0)), resource(other.resource),
+      pool(std::exchange(other.pool, nullptr)) {}
+JsonObject &JsonObject::operator=(const JsonObject &other) {
+    if (this != &other) {
+        // other may live inside this object, so build the copy first
+        JsonObject copy(resource);
+        copy.copy_from(other);
+        swap(copy);
+    }
+    return *this;
+}
+JsonObject &JsonObject::operator=(JsonObject &&other) {
+    if (this == &other) {
+        return *this;
+    }
+    if (*resource == *other.resource) {
+        JsonObject moved(std::move(other));
+        moved.resource = resource;
+        swap(moved);
+        return *this;
+    }
+    JsonObject moved(resource);
+    moved.set_pool(other.pool);
+    moved.reserve(other.count);
+    for (auto &entry : other) {
+        new (moved.entries + moved.count) Entry{entry.key, std::move(entry.value)};
+        ++moved.count;
+    }
+    moved.rebuild_index();
+    swap(moved);
+    return *this;
+}
+JsonObject::~JsonObject() {
+    clear();
+    set_pool(nullptr);
+}
+size_t JsonObject::allocated_bytes() const {
+    return entries == nullptr ? 0 : allocation_size(capacity);
+}
+
+void JsonObject::swap(JsonObject &other) noexcept {
+    std::swap(entries, other.entries);
+    std::swap(count, other.count);
+    std::swap(capacity, other.capacity);
+    std::swap(resource, other.resource);
+    std::swap(pool, other.pool);
+}
+uint32_t *JsonObject::index() const {
+    if (capacity <= index_threshold) {
+        return nullptr;
+    }
+    return reinterpret_cast<uint32_t *>(entries + capacity); // NOLINT
+}
+void JsonObject::reserve(size_t size) {
+    if (size <= capacity) {
+        return;
+    }
+    auto *grown = static_cast<Entry *>(
+        resource->allocate(allocation_size(size), alignof(Entry)));
+    for (uint32_t i = 0; i < count; ++i) {
+        new (grown + i) Entry{entries[i].key, std::move(entries[i].value)};
+        entries[i].~Entry();
+    }
+    if (entries != nullptr) {
+        resource->deallocate(entries, allocation_size(capacity),
+                             alignof(Entry));
+    }
+    entries = grown;
+    capacity = static_cast<uint32_t>(size);
+    rebuild_index();
+}
+void JsonObject::rebuild_index() {
+    auto *slots = index();
+    if (slots == nullptr) {
+        return;
+    }
+    std::fill_n(slots, table_size(capacity), 0);
+    for (size_t i = 0; i < count; ++i) {
+        insert_index(i);
+    }
+}
+void JsonObject::insert_index(size_t position) {
+    auto *slots = index();
+    auto mask = table_size(capacity) - 1;
+    auto slot = slot_of(entries[position].key.data(), mask);
+    while (slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = static_cast<uint32_t>(position + 1);
+}
+void JsonObject::clear() {
+    for (auto &entry : *this) {
+        entry.~Entry();
+    }
+    if (entries != nullptr) {
+        resource->deallocate(entries, allocation_size(capacity),
+                             alignof(Entry));
+    }
+    entries = nullptr;
+    count = 0;
+    capacity = 0;
+}
+namespace {
+// The pool of the copy in progress on this thread. A copy must not share
+// the source's pool: interning isn't thread-safe, and the copy may be
+// used on another thread. The objects of one copy share a new pool
+// instead, like the objects of a parsed document.
+thread_local KeyPool *copy_pool = nullptr;
+
+struct CopyPool {
+    KeyPool *created = nullptr;
+    CopyPool() {
+        if (copy_pool == nullptr) {
+            created = copy_pool = KeyPool::create();
+        }
+    }
+    CopyPool(const CopyPool &) = delete;
+    CopyPool &operator=(const CopyPool &) = delete;
+    ~CopyPool() {
+        if (created != nullptr) {
+            copy_pool = nullptr;
+            created->release();
+        }
+    }
+};
+} // namespace
+
+void JsonObject::copy_from(const JsonObject &other) {
+    if (other.count == 0) {
+        return;
+    }
+    CopyPool scope;
+    set_pool(copy_pool);
+    reserve(other.count);
+    for (const auto &entry : other) {
+        new (entries + count) Entry{pool->intern(entry.key), entry.value};
+        ++count;
+    }
+    rebuild_index();
+}
+void JsonObject::set_pool(KeyPool *other) {
+    if (other != nullptr) {
+        other->retain();
+    }
+    if (pool != nullptr) {
+        pool->release();
+    }
+    pool = other;
+}
+
+const Json *JsonObject::find(std::string_view key) const {
+    auto *slots = index();
+    if (slots == nullptr) {
+        for (const auto &entry : *this) {
+            if (entry.key == key) {
+                return &entry.value;
+            }
+        }
+        return nullptr;
+    }
+    // a key that isn't in the pool isn't in any of its objects
+    const auto *interned = pool->find(key);
+    if (interned == nullptr) {
+        return nullptr;
+    }
+    auto mask = table_size(capacity) - 1;
+    for (auto slot = slot_of(interned->data(), mask); slots[slot] != 0;
+         slot = (slot + 1) & mask) {
+        const auto &entry = entries[slots[slot] - 1];
+        if (entry.key.data() == interned->data()) {
+            return &entry.value;
+        }
+    }
+    return nullptr;
+}
+Json *JsonObject::find(std::string_view key) {
+    return const_cast<Json *>(std::as_const(*this).find(key));
+}
+const Json &JsonObject::at(std::string_view key) const {
+    const auto *value = find(key);
+    if (value == nullptr) {
+        throw std::out_of_range("key not found");
+    }
+    return *value;
+}
+Json &JsonObject::at(std::string_view key) {
+    return const_cast<Json &>(std::as_const(*this).at(key));
+}
+Json *JsonObject::add(std::string_view key, Json &&value) {
+    if (pool == nullptr) {
+        pool = KeyPool::create();
+    }
+    auto interned = pool->intern(key);
+    if (count == capacity) {
+        reserve(std::max<size_t>(4, capacity * 2));
+    }
+    new (entries + count) Entry{interned, std::move(value)};
+    ++count;
+    if (index() != nullptr) {
+        insert_index(count - 1);
+    }
+    return &entries[count - 1].value;
+}
+void JsonObject::assign(KeyPool *pool, const std::string_view *keys,
+                        Json *values, size_t size) {
+    clear();
+    set_pool(pool);
+    reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        new (entries + i) Entry{keys[i], std::move(values[i])};
+    }
+    count = static_cast<uint32_t>(size);
+    rebuild_index();
+}
+
+bool operator==(const JsonObject &lhs, const JsonObject &rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    return std::all_of(lhs.begin(), lhs.end(), [&](const auto &entry) {
+        const auto *value = rhs.find(entry.key);
+        return value != nullptr && *value == entry.value;
+    });
+}
@@ -0,0 +1,150 @@
+#include "JsonWriter.hpp"
+#include <ostream>
+#include <stdexcept>
+
+JsonWriter::JsonWriter(std::ostream &os, int size)
+    : out(&buffer), size(size), sink([&os](std::string_view data) {
+          os.write(data.data(), static_cast<std::streamsize>(data.size()));
+      }) {
+    buffer.reserve(flush_size * 2);
+}
+JsonWriter::JsonWriter(int fd, int size)
+    : out(&buffer), size(size),
+      sink([fd](std::string_view data) { dump_write(fd, data); }) {
+    buffer.reserve(flush_size * 2);
+}
+
+void JsonWriter::newline(size_t level) {
+    if (size != 0) {
+        out->push_back('\n');
+        out->append(size * level, ' ');
+    }
+}
+
+// Writes what goes between the previous value and this one.
+void JsonWriter::before_value() {
+    if (frames.empty()) {
+        if (done) {
+            throw std::logic_error("JsonWriter : document already complete");
+        }
+        return;
+    }
+    auto &frame = frames.back();
+    if (frame.object) {
+        if (!after_key) {
+            throw std::logic_error("JsonWriter : value without a key");
+        }
+        after_key = false;
+        return;
+    }
+    if (!frame.first) {
+        out->push_back(',');
+    }
+    newline(frames.size());
+}
+void JsonWriter::after_value() {
+    if (frames.empty()) {
+        done = true;
+    } else {
+        frames.back().first = false;
+    }
+    if (sink && out->size() >= flush_size) {
+        sink(*out);
+        out->clear();
+    }
+}
+
+JsonWriter &JsonWriter::key(std::string_view key) {
+    if (frames.empty() || !frames.back().object || after_key) {
+        throw std::logic_error("JsonWriter : key outside an object");
+    }
+    auto &frame = frames.back();
+    if (!frame.first) {
+        out->push_back(',');
+    }
+    frame.first = false;
+    newline(frames.size());
+    dump_string_to(*out, key);
+    out->push_back(':');
+    if (size != 0) {
+        out->push_back(' ');
+    }
+    after_key = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::begin_array() {
+    before_value();
+    out->push_back('[');
+    frames.push_back({false, true});
+    return *this;
+}
+JsonWriter &JsonWriter::begin_object() {
+    before_value();
+    out->push_back('{');
+    frames.push_back({true, true});
+    return *this;
+}
+void JsonWriter::end(bool object) {
+    if (frames.empty() || frames.back().object != object || after_key) {
+        throw std::logic_error(object ? "JsonWriter : unmatched end_object"
+                                      : "JsonWriter : unmatched end_array");
+    }
+    bool empty = frames.back().first;
+    frames.pop_back();
+    // empty containers stay on one line, as in Json::dump
+    if (!empty) {
+        newline(frames.size());
+    }
+    out->push_back(object ? '}' : ']');
+    after_value();
+}
+JsonWriter &JsonWriter::end_array() {
+    end(false);
+    return *this;
+}
+JsonWriter &JsonWriter::end_object() {
+    end(true);
+    return *this;
+}
+
+JsonWriter &JsonWriter::null() {
+    before_value();
+    out->append("null");
+    after_value();
+    return *this;
+}
+JsonWriter &JsonWriter::value(bool value) {
+    before_value();
+    out->append(value ? "true" : "false");
+    after_value();
+    return *this;
+}
+JsonWriter &JsonWriter::value(double value) {
+    before_value();
+    dump_number_to(*out, value);
+    after_value();
+    return *this;
+}
+JsonWriter &JsonWriter::value(std::string_view value) {
+    before_value();
+    dump_string_to(*out, value);
+    after_value();
+    return *this;
+}
+JsonWriter &JsonWriter::value(RawNumber value) {
+    before_value();
+    out->append(value.text);
+    after_value();
+    return *this;
+}
+
+void JsonWriter::finish() {
+    if (!done) {
+        throw std::logic_error("JsonWriter : document incomplete");
+    }
+    if (sink) {
+        sink(*out);
+        out->clear();
+    }
+}
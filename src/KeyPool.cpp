@@ -0,0 +1,14 @@
+#include "KeyPool.hpp"
+#include <cstring>
+
+std::string_view KeyPool::intern(std::string_view key) {
+    if (auto it = keys.find(key); it != keys.end()) {
+        return *it;
+    }
+    // 多分配一个字节, 让空 key 也有唯一的地址
+    auto *copy = static_cast<char *>(storage.allocate(key.size() + 1, 1));
+    if (!key.empty()) {
+        std::memcpy(copy, key.data(), key.size());
+    }
+    return *keys.emplace(copy, key.size()).first;
+}
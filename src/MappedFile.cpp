@@ -0,0 +1,62 @@
+#include "MappedFile.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+[[noreturn]] void fail(const std::string &what, const std::string &path) {
+    throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+} // namespace
+
+MappedFile::MappedFile(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fail("cannot open", path);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        length = static_cast<size_t>(info.st_size);
+        void *addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            ::madvise(addr, length, MADV_SEQUENTIAL);
+            mapping = static_cast<const char *>(addr);
+            ::close(fd);
+            return;
+        }
+        length = 0;
+    }
+    // 管道等无法映射的输入: 退回到分块读取
+    constexpr size_t block_size = 64 * 1024;
+    for (;;) {
+        auto size = buffer.size();
+        buffer.resize(size + block_size);
+        auto got = ::read(fd, buffer.data() + size, block_size);
+        if (got < 0 && errno == EINTR) {
+            buffer.resize(size);
+            continue;
+        }
+        if (got <= 0) {
+            buffer.resize(size);
+            if (got < 0) {
+                int error = errno;
+                ::close(fd);
+                errno = error;
+                fail("cannot read", path);
+            }
+            break;
+        }
+        buffer.resize(size + static_cast<size_t>(got));
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (mapping != nullptr) {
+        ::munmap(const_cast<char *>(mapping), length);
+    }
+}
@@ -0,0 +1,335 @@
+#include "MessagePack.hpp"
+#include "Sax.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+void put_byte(std::string &out, uint8_t byte) {
+    out.push_back(static_cast<char>(byte));
+}
+// `tag`, then `value` in `size` bytes, big endian
+void put(std::string &out, uint8_t tag, uint64_t value, size_t size) {
+    put_byte(out, tag);
+    for (auto shift = size * 8; shift != 0;) {
+        shift -= 8;
+        put_byte(out, static_cast<uint8_t>(value >> shift));
+    }
+}
+void put_unsigned(std::string &out, uint64_t value) {
+    if (value <= 0x7F) {
+        put_byte(out, static_cast<uint8_t>(value)); // positive fixint
+    } else if (value <= UINT8_MAX) {
+        put(out, 0xCC, value, 1);
+    } else if (value <= UINT16_MAX) {
+        put(out, 0xCD, value, 2);
+    } else if (value <= UINT32_MAX) {
+        put(out, 0xCE, value, 4);
+    } else {
+        put(out, 0xCF, value, 8);
+    }
+}
+void put_signed(std::string &out, int64_t value) {
+    if (value >= 0) {
+        put_unsigned(out, static_cast<uint64_t>(value));
+    } else if (value >= -32) {
+        put_byte(out, static_cast<uint8_t>(value)); // negative fixint
+    } else if (value >= INT8_MIN) {
+        put(out, 0xD0, static_cast<uint64_t>(value) & 0xFF, 1);
+    } else if (value >= INT16_MIN) {
+        put(out, 0xD1, static_cast<uint64_t>(value) & 0xFFFF, 2);
+    } else if (value >= INT32_MIN) {
+        put(out, 0xD2, static_cast<uint64_t>(value) & 0xFFFFFFFF, 4);
+    } else {
+        put(out, 0xD3, static_cast<uint64_t>(value), 8);
+    }
+}
+// fix, 8, 16 and 32 bit length forms; str8 has no array/map counterpart
+void put_length(std::string &out, size_t length, uint8_t fix, size_t fix_max,
+                uint8_t tag8, uint8_t tag16) {
+    if (length <= fix_max) {
+        put_byte(out, static_cast<uint8_t>(fix | length));
+    } else if (tag8 != 0 && length <= UINT8_MAX) {
+        put(out, tag8, length, 1);
+    } else if (length <= UINT16_MAX) {
+        put(out, tag16, length, 2);
+    } else if (length <= UINT32_MAX) {
+        put(out, tag16 + 1, length, 4);
+    } else {
+        throw std::length_error("msgpack: container or string too long");
+    }
+}
+void put_string(std::string &out, std::string_view string) {
+    put_length(out, string.size(), 0xA0, 31, 0xD9, 0xDA);
+    out.append(string);
+}
+
+// NOLINTBEGIN(*-no-recursion)
+void put_value(std::string &out, const Json &json) {
+    switch (json.get_type()) {
+    case Json::Type::NULL_:
+        put_byte(out, 0xC0);
+        break;
+    case Json::Type::BOOL_:
+        put_byte(out, json.as<bool>() ? 0xC3 : 0xC2);
+        break;
+    case Json::Type::NUMBER:
+        if (const auto *i = json.get_if<int64_t>()) {
+            put_signed(out, *i);
+        } else if (const auto *u = json.get_if<uint64_t>()) {
+            put_unsigned(out, *u);
+        } else if (const auto *d = json.get_if<double>()) {
+            put(out, 0xCB, std::bit_cast<uint64_t>(*d), 8);
+        } else {
+            put_value(out, Json::parse_number(json.as<RawNumber>().text));
+        }
+        break;
+    case Json::Type::STRING:
+        put_string(out, json.as<std::string_view>());
+        break;
+    case Json::Type::ARRAY: {
+        const auto &array = json.as<Json::arraytype>();
+        put_length(out, array.size(), 0x90, 15, 0, 0xDC);
+        for (const auto &element : array) {
+            put_value(out, element);
+        }
+        break;
+    }
+    case Json::Type::OBJECT: {
+        const auto &object = json.as<Json::objecttype>();
+        put_length(out, object.size(), 0x80, 15, 0, 0xDE);
+        for (const auto &[key, member] : object) {
+            put_string(out, key);
+            put_value(out, member);
+        }
+        break;
+    }
+    }
+}
+// NOLINTEND(*-no-recursion)
+
+// Walks the encoded value with an explicit container stack, so deeply
+// nested input can't overflow the call stack.
+class Decoder {
+  public:
+    Decoder(std::string_view data, SaxHandler &handler, ParseOptions options)
+        : data(data), handler(&handler), options(options) {}
+
+    void run() {
+        value();
+        while (!frames.empty()) {
+            auto &frame = frames.back();
+            if (frame.remaining == 0) {
+                bool object = frame.object;
+                frames.pop_back();
+                if (object) {
+                    handler->end_object();
+                } else {
+                    handler->end_array();
+                }
+                value_done();
+            } else if (frame.key_next) {
+                frame.key_next = false;
+                key();
+            } else {
+                value();
+            }
+        }
+        if (pos != data.size()) {
+            error("trailing bytes");
+        }
+    }
+
+  private:
+    struct Frame {
+        uint64_t remaining; // elements, or members for maps
+        bool object;
+        bool key_next;
+    };
+    std::string_view data;
+    SaxHandler *handler;
+    ParseOptions options;
+    size_t pos = 0;
+    std::vector<Frame> frames;
+
+    [[noreturn]] void error(const char *message) const {
+        throw std::runtime_error(std::string("msgpack: ") + message +
+                                 " at offset " + std::to_string(pos));
+    }
+    uint64_t take(size_t size) {
+        if (data.size() - pos < size) {
+            error("unexpected end of input");
+        }
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; ++i) {
+            value = value << 8 | static_cast<uint8_t>(data[pos++]);
+        }
+        return value;
+    }
+    std::string_view take_string(uint64_t size) {
+        if (data.size() - pos < size) {
+            error("unexpected end of input");
+        }
+        auto string = data.substr(pos, size);
+        pos += size;
+        return string;
+    }
+    void value_done() {
+        if (!frames.empty()) {
+            auto &frame = frames.back();
+            --frame.remaining;
+            frame.key_next = frame.object;
+        }
+    }
+    void start(bool object, uint64_t size) {
+        // every element takes at least a byte
+        if (size > data.size() - pos) {
+            error("unexpected end of input");
+        }
+        if (object) {
+            handler->start_object();
+        } else {
+            handler->start_array();
+        }
+        frames.push_back({size, object, object});
+    }
+    void string(std::string_view string) {
+        if (options.borrow_strings) {
+            handler->string(string);
+        } else {
+            handler->string(std::string(string));
+        }
+        value_done();
+    }
+    void key() {
+        auto at = pos;
+        auto tag = static_cast<uint8_t>(take(1));
+        uint64_t size = 0;
+        if ((tag & 0xE0) == 0xA0) {
+            size = tag & 0x1F;
+        } else if (tag == 0xD9 || tag == 0xDA || tag == 0xDB) {
+            size = take(size_t{1} << (tag - 0xD9));
+        } else {
+            pos = at;
+            error("map key is not a string");
+        }
+        if (!handler->key(take_string(size))) {
+            pos = at;
+            error("duplicate map key");
+        }
+    }
+    void value();
+};
+
+void Decoder::value() {
+    auto at = pos;
+    auto tag = static_cast<uint8_t>(take(1));
+    if (tag <= 0x7F) {
+        handler->int64(tag);
+    } else if (tag >= 0xE0) {
+        handler->int64(static_cast<int8_t>(tag));
+    } else if ((tag & 0xF0) == 0x80) {
+        start(true, tag & 0x0F);
+        return;
+    } else if ((tag & 0xF0) == 0x90) {
+        start(false, tag & 0x0F);
+        return;
+    } else if ((tag & 0xE0) == 0xA0) {
+        string(take_string(tag & 0x1F));
+        return;
+    } else {
+        switch (tag) {
+        case 0xC0:
+            handler->null();
+            break;
+        case 0xC2:
+        case 0xC3:
+            handler->boolean(tag == 0xC3);
+            break;
+        case 0xCA:
+            handler->number(
+                std::bit_cast<float>(static_cast<uint32_t>(take(4))));
+            break;
+        case 0xCB:
+            handler->number(std::bit_cast<double>(take(8)));
+            break;
+        case 0xCC:
+        case 0xCD:
+        case 0xCE:
+        case 0xCF: {
+            auto value = take(size_t{1} << (tag - 0xCC));
+            if (value <= INT64_MAX) {
+                handler->int64(static_cast<int64_t>(value));
+            } else {
+                handler->uint64(value);
+            }
+            break;
+        }
+        case 0xD0:
+            handler->int64(static_cast<int8_t>(take(1)));
+            break;
+        case 0xD1:
+            handler->int64(static_cast<int16_t>(take(2)));
+            break;
+        case 0xD2:
+            handler->int64(static_cast<int32_t>(take(4)));
+            break;
+        case 0xD3:
+            handler->int64(static_cast<int64_t>(take(8)));
+            break;
+        case 0xD9:
+        case 0xDA:
+        case 0xDB:
+            string(take_string(take(size_t{1} << (tag - 0xD9))));
+            return;
+        case 0xDC:
+        case 0xDD:
+            start(false, take(size_t{2} << (tag - 0xDC)));
+            return;
+        case 0xDE:
+        case 0xDF:
+            start(true, take(size_t{2} << (tag - 0xDE)));
+            return;
+        default:
+            pos = at;
+            error("unsupported type");
+        }
+    }
+    value_done();
+}
+} // namespace
+
+void to_msgpack(const Json &json, std::string &out) { put_value(out, json); }
+std::string to_msgpack(const Json &json) {
+    std::string out;
+    put_value(out, json);
+    return out;
+}
+
+void from_msgpack(std::string_view data, SaxHandler &handler,
+                  ParseOptions options) {
+    Decoder(data, handler, options).run();
+}
+Json from_msgpack(std::string_view data, std::pmr::memory_resource *resource,
+                  ParseOptions options) {
+    DomBuilder builder(resource, options.stats);
+    from_msgpack(data, builder, options);
+    return std::move(builder.result());
+}
+
+Document load_msgpack_file(const std::string &path, ParseOptions options) {
+    auto source = std::make_unique<MappedFile>(path);
+    auto data = source->view();
+    Document document{std::make_unique<std::pmr::monotonic_buffer_resource>(
+                          std::max<size_t>(data.size(), 1024)),
+                      Json{}, std::move(source)};
+    document.root = from_msgpack(data, document.arena.get(), options);
+    return document;
+}
@@ -0,0 +1,321 @@
+#include "OnDemand.hpp"
+#include "Scan.hpp"
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+namespace {
+[[noreturn]] void malformed(const char *message) {
+    throw std::runtime_error(std::string("on-demand: ") + message);
+}
+
+const char *skip_ws(const char *p, const char *end) {
+    while (p != end &&
+           (*p == '\x20' || *p == '\x09' || *p == '\x0A' || *p == '\x0D')) {
+        ++p;
+    }
+    return p;
+}
+
+// `p` is on the opening quote; returns the position after the closing one.
+const char *skip_string(const char *p, const char *end) {
+    ++p;
+    while (true) {
+        p = find_string_special(p, end);
+        if (p == end) {
+            malformed("unterminated string");
+        }
+        if (*p == '\x22') {
+            return p + 1;
+        }
+        p += *p == '\x5C' ? 2 : 1;
+        if (p > end) {
+            malformed("unterminated string");
+        }
+    }
+}
+
+// `p` is on the first byte of a value; returns the position after it.
+const char *skip_value(const char *p, const char *end) {
+    switch (*p) {
+    case '\x22':
+        return skip_string(p, end);
+    case '[':
+    case '{': {
+        size_t depth = 0;
+        while (true) {
+            p = find_container_special(p, end);
+            if (p == end) {
+                malformed("unterminated container");
+            }
+            switch (*p) {
+            case '\x22':
+                p = skip_string(p, end);
+                continue;
+            case '[':
+            case '{':
+                ++depth;
+                break;
+            default:
+                if (--depth == 0) {
+                    return p + 1;
+                }
+            }
+            ++p;
+        }
+    }
+    default:
+        // number or literal: runs to the next delimiter
+        while (p != end && *p != ',' && *p != ']' && *p != '}' &&
+               *p != '\x20' && *p != '\x09' && *p != '\x0A' && *p != '\x0D') {
+            ++p;
+        }
+        return p;
+    }
+}
+
+// After a member or element: the position after `,`, or nullptr at the
+// closing bracket.
+const char *next_item(const char *p, const char *end, char close) {
+    p = skip_ws(p, end);
+    if (p != end && *p == ',') {
+        return skip_ws(p + 1, end);
+    }
+    if (p != end && *p == close) {
+        return nullptr;
+    }
+    malformed("expected `,` or a closing bracket");
+}
+
+template <class Item>
+constexpr char closing = std::is_same_v<Item, LazyMember> ? '}' : ']';
+
+// The key text between the quotes, which has escapes, decoded.
+std::string unescape_key(std::string_view text) {
+    std::string quoted(text.data() - 1, text.size() + 2);
+    Lexer lexer(quoted);
+    auto token = lexer.get_next_token();
+    return std::move(std::get<std::string>(token.value));
+}
+
+// Compares the key text between the quotes with `key`, decoding escapes
+// only when there are any.
+bool key_equals(std::string_view text, std::string_view key) {
+    if (text.find('\x5C') == std::string_view::npos) {
+        return text == key;
+    }
+    return unescape_key(text) == key;
+}
+
+// One reference token of a JSON Pointer with ~1 and ~0 decoded.
+std::string unescape_pointer(std::string_view token) {
+    std::string out;
+    for (size_t i = 0; i < token.size(); ++i) {
+        if (token[i] == '~' && i + 1 < token.size() &&
+            (token[i + 1] == '0' || token[i + 1] == '1')) {
+            out.push_back(token[i + 1] == '0' ? '~' : '/');
+            ++i;
+        } else {
+            out.push_back(token[i]);
+        }
+    }
+    return out;
+}
+} // namespace
+
+LazyValue::LazyValue(std::string_view document)
+    : begin(skip_ws(document.data(), document.data() + document.size())),
+      end(document.data() + document.size()) {
+    if (begin == end) {
+        malformed("empty document");
+    }
+}
+
+Json::Type LazyValue::get_type() const {
+    switch (*begin) {
+    case '{':
+        return Json::Type::OBJECT;
+    case '[':
+        return Json::Type::ARRAY;
+    case '\x22':
+        return Json::Type::STRING;
+    case 't':
+    case 'f':
+        return Json::Type::BOOL_;
+    case 'n':
+        return Json::Type::NULL_;
+    case '-':
+    case '0' ... '9':
+        return Json::Type::NUMBER;
+    default:
+        malformed("expected a value");
+    }
+}
+
+LazyRange<LazyValue> LazyValue::elements() const {
+    if (get_type() != Json::Type::ARRAY) {
+        throw std::logic_error("only array has elements");
+    }
+    return {LazyIterator<LazyValue>(skip_ws(begin + 1, end), end)};
+}
+LazyRange<LazyMember> LazyValue::members() const {
+    if (get_type() != Json::Type::OBJECT) {
+        throw std::logic_error("only object has members");
+    }
+    return {LazyIterator<LazyMember>(skip_ws(begin + 1, end), end)};
+}
+
+std::optional<LazyValue> LazyValue::find(std::string_view key) const {
+    if (get_type() != Json::Type::OBJECT) {
+        throw std::logic_error("only object can use string index");
+    }
+    for (auto member : members()) {
+        if (key_equals(member.raw_key, key)) {
+            return member.value;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<LazyValue> LazyValue::find(size_t index) const {
+    if (get_type() != Json::Type::ARRAY) {
+        throw std::logic_error("only array can use integer index");
+    }
+    size_t i = 0;
+    for (auto element : elements()) {
+        if (i++ == index) {
+            return element;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<LazyValue>
+LazyValue::find_pointer(std::string_view pointer) const {
+    std::optional<LazyValue> value = *this;
+    while (!pointer.empty()) {
+        if (pointer.front() != '/') {
+            throw std::invalid_argument("JSON Pointer must start with `/`");
+        }
+        pointer.remove_prefix(1);
+        auto slash = pointer.find('/');
+        auto token = unescape_pointer(pointer.substr(0, slash));
+        pointer.remove_prefix(slash == std::string_view::npos ? pointer.size()
+                                                              : slash);
+        switch (value->get_type()) {
+        case Json::Type::OBJECT:
+            value = value->find(token);
+            break;
+        case Json::Type::ARRAY: {
+            size_t index{};
+            const auto *last = token.data() + token.size();
+            auto result = std::from_chars(token.data(), last, index);
+            // no sign, no leading zeros, and "-" (past the end) never exists
+            if (token.empty() || result.ec != std::errc{} ||
+                result.ptr != last || (token.size() > 1 && token[0] == '0')) {
+                return std::nullopt;
+            }
+            value = value->find(index);
+            break;
+        }
+        default:
+            return std::nullopt;
+        }
+        if (!value) {
+            return std::nullopt;
+        }
+    }
+    return value;
+}
+
+LazyValue LazyValue::operator[](std::string_view key) const {
+    auto value = find(key);
+    if (!value) {
+        throw std::out_of_range("key not found");
+    }
+    return *value;
+}
+LazyValue LazyValue::operator[](size_t index) const {
+    auto value = find(index);
+    if (!value) {
+        throw std::out_of_range("index out of range");
+    }
+    return *value;
+}
+
+std::string_view LazyValue::raw() const {
+    return {begin, skip_value(begin, end)};
+}
+Json LazyValue::parse(std::pmr::memory_resource *resource,
+                      ParseOptions options) const {
+    return inline_parse(raw(), resource, options);
+}
+
+std::string LazyMember::key() const {
+    if (raw_key.find('\x5C') == std::string_view::npos) {
+        return std::string(raw_key);
+    }
+    return unescape_key(raw_key);
+}
+
+template <class Item>
+LazyIterator<Item>::LazyIterator(const char *p, const char *end) : end(end) {
+    if (p == end || *p != closing<Item>) {
+        read_item(p);
+    }
+}
+
+// `p` is on the first byte of an item: its key for members.
+template <class Item> void LazyIterator<Item>::read_item(const char *p) {
+    if constexpr (std::is_same_v<Item, LazyMember>) {
+        if (p == end || *p != '\x22') {
+            malformed("expected a key");
+        }
+        const auto *key_end = skip_string(p, end);
+        raw_key = std::string_view(p + 1, key_end - 1);
+        p = skip_ws(key_end, end);
+        if (p == end || *p != ':') {
+            malformed("expected `:`");
+        }
+        p = skip_ws(p + 1, end);
+    }
+    // a missing value, as in `[1,]` or `[,]`
+    if (p == end || *p == ',' || *p == ']' || *p == '}') {
+        malformed("expected a value");
+    }
+    value = p;
+}
+
+template <class Item> Item LazyIterator<Item>::operator*() const {
+    if constexpr (std::is_same_v<Item, LazyMember>) {
+        return {raw_key, LazyValue(value, end)};
+    } else {
+        return LazyValue(value, end);
+    }
+}
+
+template <class Item> LazyIterator<Item> &LazyIterator<Item>::operator++() {
+    const auto *p = next_item(skip_value(value, end), end, closing<Item>);
+    if (p == nullptr) {
+        *this = {};
+    } else {
+        read_item(p);
+    }
+    return *this;
+}
+
+template class LazyIterator<LazyValue>;
+template class LazyIterator<LazyMember>;
+
+std::optional<Json> parse_pointer(std::string_view data,
+                                  std::string_view pointer,
+                                  std::pmr::memory_resource *resource,
+                                  ParseOptions options) {
+    auto value = LazyValue(data).find_pointer(pointer);
+    if (!value) {
+        return std::nullopt;
+    }
+    return value->parse(resource, options);
+}
@@ -0,0 +1,217 @@
+#include "Reader.hpp"
+#include "Sax.hpp"
+#include "WorkerPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr size_t min_chunk_size = 64 * 1024;
+
+// Whether the character at `p` follows an odd run of backslashes. That
+// alone decides if a quote is escaped, whatever the string state.
+bool escaped_at(const char *begin, const char *p) {
+    bool escaped = false;
+    while (p != begin && *--p == '\\') {
+        escaped = !escaped;
+    }
+    return escaped;
+}
+
+// What a chunk does to the string state and the nesting depth. The chunk
+// is scanned once assuming it starts outside a string; the positions that
+// assumption puts inside strings are exactly the ones outside strings if
+// it actually starts inside one, so depth[1] covers that case.
+struct ChunkSummary {
+    bool flips_string = false; // odd number of unescaped quotes
+    long depth[2] = {0, 0};    // net change starting outside / inside
+};
+ChunkSummary summarize(const char *begin, const char *first,
+                       const char *last) {
+    ChunkSummary summary;
+    bool in_string = false;
+    bool escaped = escaped_at(begin, first);
+    for (const auto *p = first; p != last; ++p) {
+        if (escaped) {
+            escaped = false;
+            continue;
+        }
+        switch (*p) {
+        case '\\':
+            escaped = true;
+            break;
+        case '"':
+            in_string = !in_string;
+            break;
+        case '[':
+        case '{':
+            ++summary.depth[in_string ? 1 : 0];
+            break;
+        case ']':
+        case '}':
+            --summary.depth[in_string ? 1 : 0];
+            break;
+        default:
+            break;
+        }
+    }
+    summary.flips_string = in_string;
+    return summary;
+}
+
+// Top-level commas of the array in a chunk, and its closing bracket if the
+// chunk has it, given the real state at the chunk's start.
+struct ChunkBoundaries {
+    bool in_string = false;
+    long depth = 0;
+    std::vector<const char *> commas;
+    const char *close = nullptr;
+};
+void find_boundaries(const char *begin, const char *first, const char *last,
+                     ChunkBoundaries &chunk) {
+    bool in_string = chunk.in_string;
+    long depth = chunk.depth;
+    bool escaped = escaped_at(begin, first);
+    for (const auto *p = first; p != last; ++p) {
+        if (escaped) {
+            escaped = false;
+            continue;
+        }
+        if (*p == '\\') {
+            escaped = true;
+        } else if (*p == '"') {
+            in_string = !in_string;
+        } else if (in_string) {
+            continue;
+        } else if (*p == '[' || *p == '{') {
+            ++depth;
+        } else if (*p == ']' || *p == '}') {
+            if (--depth == 0) {
+                chunk.close = p;
+                return;
+            }
+        } else if (*p == ',' && depth == 1) {
+            chunk.commas.push_back(p);
+        }
+    }
+}
+
+bool is_ws(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+} // namespace
+
+Json parallel_parse(std::string_view data, WorkerPool &pool,
+                    std::pmr::memory_resource *resource,
+                    ParseOptions options) {
+    auto sequential = [&]() {
+        return threaded_parse(data, inline_parse_threshold, resource, options);
+    };
+    const char *begin = data.data();
+    const char *end = data.data() + data.size();
+    const char *open = std::find_if_not(begin, end, is_ws);
+    if (data.size() < 2 * min_chunk_size || open == end || *open != '[') {
+        return sequential();
+    }
+
+    // 1. per chunk string flips and depth changes, in parallel
+    const size_t participants = pool.size() + 1;
+    const size_t chunk_count = std::clamp<size_t>(
+        data.size() / min_chunk_size, 1, participants * 4);
+    auto chunk_begin = [&](size_t c) {
+        return begin + data.size() * c / chunk_count;
+    };
+    std::vector<ChunkSummary> summaries(chunk_count);
+    pool.parallel_for(chunk_count, [&](size_t c) {
+        summaries[c] = summarize(begin, chunk_begin(c), chunk_begin(c + 1));
+    });
+
+    // 2. resolve the state at every chunk start, then collect the top-level
+    // commas in parallel
+    std::vector<ChunkBoundaries> chunks(chunk_count);
+    bool in_string = false;
+    long depth = 0;
+    for (size_t c = 0; c < chunk_count; ++c) {
+        chunks[c].in_string = in_string;
+        chunks[c].depth = depth;
+        depth += summaries[c].depth[in_string ? 1 : 0];
+        in_string = in_string != summaries[c].flips_string;
+        if (depth < 0) {
+            return sequential();
+        }
+    }
+    if (in_string || depth != 0) {
+        return sequential();
+    }
+    pool.parallel_for(chunk_count, [&](size_t c) {
+        find_boundaries(begin, chunk_begin(c), chunk_begin(c + 1), chunks[c]);
+    });
+    std::vector<const char *> commas;
+    const char *close = nullptr;
+    for (auto &chunk : chunks) {
+        commas.insert(commas.end(), chunk.commas.begin(), chunk.commas.end());
+        if (chunk.close != nullptr) {
+            close = chunk.close;
+            break;
+        }
+    }
+    if (close == nullptr || *close != ']' ||
+        std::find_if_not(close + 1, end, is_ws) != end) {
+        return sequential();
+    }
+
+    // 3. parse the elements in parallel, a group of them per task so the
+    // builder (and its key pool) is shared within a group
+    auto element = [&](size_t i) {
+        const char *first = i == 0 ? open + 1 : commas[i - 1] + 1;
+        const char *last = i == commas.size() ? close : commas[i];
+        return std::string_view(first, last);
+    };
+    size_t count = commas.size() + 1;
+    if (count == 1 && std::all_of(open + 1, close, is_ws)) {
+        count = 0;
+    }
+    std::vector<Json> elements(count);
+    const size_t group_size = std::max<size_t>(1, count / (participants * 16));
+    const size_t group_count = (count + group_size - 1) / group_size;
+    std::atomic<bool> failed{false};
+    auto element_options = options;
+    element_options.stats = nullptr; // not shareable between threads
+    pool.parallel_for(group_count, [&](size_t g) {
+        if (failed.load(std::memory_order_relaxed)) {
+            return;
+        }
+        try {
+            DomBuilder builder(resource);
+            auto last = std::min(count, (g + 1) * group_size);
+            for (auto i = g * group_size; i < last; ++i) {
+                Lexer lexer(element(i), element_options);
+                Parser parser(lexer, resource);
+                parser.parse(builder);
+                elements[i] = std::move(builder.result());
+            }
+        } catch (const std::exception &) {
+            failed.store(true, std::memory_order_relaxed);
+        }
+    });
+    if (failed.load()) {
+        // 回到顺序解析, 让错误信息带上正确的行列号
+        return sequential();
+    }
+
+    Json root(ArrayType{}, resource);
+    auto &array = *root.get_if<Json::arraytype>();
+    array.reserve(count);
+    std::move(elements.begin(), elements.end(), std::back_inserter(array));
+    return root;
+}
+
+Json parallel_parse(std::string_view data,
+                    std::pmr::memory_resource *resource,
+                    ParseOptions options) {
+    return parallel_parse(data, WorkerPool::instance(), resource, options);
+}
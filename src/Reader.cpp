@@ -1,13 +1,19 @@
 #include "Reader.hpp"
+#include "Sax.hpp"
+#include "Scan.hpp"
+#include "WorkerPool.hpp"
 #include "json.hpp"
 #include <algorithm>
 #include <charconv>
 #include <cmath>
-#include <future>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <latch>
+#include <limits>
 #include <stdexcept>
 #include <string>
 #include <system_error>
-#include <thread>
 #include <type_traits>
 #include <utility>
 #include <variant>
@@ -66,10 +72,10 @@ std::string Token::get_value() const {
     case Type::STRING:
         return std::visit(
             []<class T>(T &&arg) {
-                if constexpr (std::is_same_v<double, std::remove_cvref_t<T>>) {
+                if constexpr (std::is_arithmetic_v<std::remove_cvref_t<T>>) {
                     return std::to_string(arg);
                 } else {
-                    return arg;
+                    return std::string(arg);
                 }
             },
             value);
@@ -77,17 +83,120 @@ std::string Token::get_value() const {
     unreachable();
 }
 
+const char *ParseError::describe(Kind kind) {
+    switch (kind) {
+    case Kind::VALUE_EXPECTED:
+        return "Value expected";
+    case Kind::UNEXPECTED_CHARACTER:
+        return "Unexpected character after value";
+    case Kind::INVALID_STRING_CHARACTER:
+        return "Unexpected character after `\\`.";
+    case Kind::INVALID_ESCAPE:
+        return "Invalid escape character in string.";
+    case Kind::INVALID_UNICODE:
+        return "Invalid unicode sequence in string.";
+    case Kind::UNTERMINATED_STRING:
+        return "Unexpected end of string.";
+    case Kind::INVALID_NUMBER:
+        return "invalid float string";
+    case Kind::NUMBER_OUT_OF_RANGE:
+        return "result out of range";
+    case Kind::UNTERMINATED_NUMBER:
+        return "Unexpected end of number";
+    case Kind::COLON_EXPECTED:
+        return "Colon expected";
+    case Kind::PROPERTY_EXPECTED:
+        return "Property expected";
+    case Kind::DUPLICATE_KEY:
+        return "Duplicate object key";
+    case Kind::COMMA_OR_BRACKET_EXPECTED:
+        return "Expected comma or closing bracket";
+    case Kind::END_OF_FILE_EXPECTED:
+        return "End of file expected";
+    }
+    unreachable();
+}
+std::string ParseError::message() const {
+    return std::to_string(line) + ":" + std::to_string(column) + ": " +
+           describe(kind);
+}
+
 Token Lexer::generate_token(Token::Type type, std::string value) const {
     return Token{lineno, colnom, type, value};
 }
+Token Lexer::generate_token(Token::Type type, std::string_view value) const {
+    return Token{lineno, colnom, type, value};
+}
 Token Lexer::generate_token(Token::Type type, double value) const {
     return Token{lineno, colnom, type, value};
 }
+Token Lexer::generate_token(Token::Type type, int64_t value) const {
+    return Token{lineno, colnom, type, value};
+}
+Token Lexer::generate_token(Token::Type type, uint64_t value) const {
+    return Token{lineno, colnom, type, value};
+}
 Token Lexer::generate_token(Token::Type type) const {
     return Token{lineno, colnom, type};
 }
+static_assert(ParseStats::token_types ==
+              static_cast<size_t>(Token::Type::STRING) + 1);
+
 Token Lexer::get_next_token() {
+    auto token = try_next_token();
+    if (error_) [[unlikely]] {
+        throw std::runtime_error(error_->message());
+    }
+    return token;
+}
+Token Lexer::try_next_token() {
+    if constexpr (stats_enabled) {
+        if (options.stats != nullptr) {
+            StatsTimer timer(options.stats, &ParseStats::lex_ns);
+            const auto *before = curr_pos;
+            auto token = scan_token();
+            options.stats->bytes_lexed += curr_pos - before;
+            ++options.stats->tokens[static_cast<size_t>(token.type)];
+            return token;
+        }
+    }
+    return scan_token();
+}
+Token Lexer::scan_token() {
+    if (structurals != nullptr) {
+        return get_indexed_token();
+    }
     skip_ws();
+    return lex_token();
+}
+Token Lexer::get_indexed_token() {
+    if (next_structural == structurals->size()) {
+        curr_pos = data_.end();
+        return generate_token(Token::Type::EOF_);
+    }
+    curr_pos = data_.begin() + (*structurals)[next_structural++];
+    auto token = lex_token();
+    switch (token.type) {
+    case Token::Type::FALSE:
+    case Token::Type::TRUE:
+    case Token::Type::NULL_:
+    case Token::Type::NUMBER:
+        // Only the first character of a number or literal is indexed, so
+        // whatever follows must be whitespace or the next indexed token.
+        if (curr_pos != data_.end() && *curr_pos != '\x20' &&
+            *curr_pos != '\x09' && *curr_pos != '\x0A' &&
+            *curr_pos != '\x0D' &&
+            (next_structural == structurals->size() ||
+             curr_pos - data_.begin() != (*structurals)[next_structural])) {
+            return fail(ParseError::Kind::UNEXPECTED_CHARACTER);
+        }
+        break;
+    default:
+        break;
+    }
+    return token;
+}
+Token Lexer::lex_token() {
     if (curr_pos == data_.end()) {
         return generate_token(Token::Type::EOF_);
     }
@@ -116,44 +225,60 @@ Token Lexer::get_next_token() {
             next(4);
             return generate_token(Token::Type::FALSE);
         }
-        error("Value expected");
+        return fail(ParseError::Kind::VALUE_EXPECTED);
     case 't':
         next(1);
         if (match("rue")) {
             next(3);
             return generate_token(Token::Type::TRUE);
         }
-        error("Value expected");
+        return fail(ParseError::Kind::VALUE_EXPECTED);
     case 'n':
         next(1);
         if (match("ull")) {
             next(3);
             return generate_token(Token::Type::NULL_);
         }
-        error("Value expected");
+        return fail(ParseError::Kind::VALUE_EXPECTED);
     case '\x22': // " quotation mark
     {
         return get_string();
     }
     case '-':
     case '0' ... '9': {
-        return get_number();
+        return options.raw_numbers ? get_raw_number() : get_number();
     }
     default:
-        error("Value expected");
+        return fail(ParseError::Kind::VALUE_EXPECTED);
     }
 }
 Token Lexer::get_string() { // NOLINT
     next();
-    std::string s;
+    // Most strings have no escapes: find the end of the clean run first and
+    // only fall back to decoding character by character after it.
+    const auto *begin = curr_pos;
+    next(static_cast<int>(find_string_special(curr_pos, data_.end()) -
+                          curr_pos));
+    std::string_view clean(begin, curr_pos);
+    if (curr_pos != data_.end() && *curr_pos == '\x22') {
+        next();
+        if (options.borrow_strings) {
+            return generate_token(Token::Type::STRING, clean);
+        }
+        return generate_token(Token::Type::STRING, std::string(clean));
+    }
+    std::string s(clean);
     while (curr_pos != data_.end()) {
         switch (*curr_pos) {
         case '\0' ... '\x19':
-            error("Unexpected character after `\\`.");
+            return fail(ParseError::Kind::INVALID_STRING_CHARACTER);
+        case '\x1A' ... '\x1F': // accepted as is, though they end a clean run
+            s.push_back(*curr_pos);
+            break;
         case '\x5C': /* \ */
             next();
             if (curr_pos == data_.end()) {
-                error("Unexpected character after `\\`.");
+                return fail(ParseError::Kind::INVALID_STRING_CHARACTER);
             }
             switch (*curr_pos) {
             case '\x5C': /* \ */
@@ -180,31 +305,31 @@ Token Lexer::get_string() { // NOLINT
             {
                 next();
                 if (curr_pos + 4 > data_.end()) {
-                    error("Invalid unicode sequence in string.");
+                    return fail(ParseError::Kind::INVALID_UNICODE);
                 }
                 unsigned int value{};
                 auto result =
                     std::from_chars(curr_pos, curr_pos + 4, value, 16);
                 if (result.ptr != curr_pos + 4) {
-                    error("Invalid unicode sequence in string.");
+                    return fail(ParseError::Kind::INVALID_UNICODE);
                 }
                 if (value >= 0xD800U && value < 0xDC00U) {
                     next(4);
                     if (!match("\\u")) {
-                        error("Invalid unicode sequence in string.");
+                        return fail(ParseError::Kind::INVALID_UNICODE);
                     }
                     next(2);
                     if (curr_pos + 4 > data_.end()) {
-                        error("Invalid unicode sequence in string.");
+                        return fail(ParseError::Kind::INVALID_UNICODE);
                     }
                     unsigned int nextvalue{};
                     auto nextresult =
                         std::from_chars(curr_pos, curr_pos + 4, nextvalue, 16);
                     if (nextresult.ptr != curr_pos + 4) {
-                        error("Invalid unicode sequence in string.");
+                        return fail(ParseError::Kind::INVALID_UNICODE);
                     }
                     if (nextvalue < 0xDC00 || nextvalue >= 0xE000) {
-                        error("Invalid unicode sequence in string.");
+                        return fail(ParseError::Kind::INVALID_UNICODE);
                     }
                     value = (0x10000 + ((value - 0xD800) << 10) +
                              (nextvalue - 0xDC00));
@@ -249,49 +374,135 @@ Token Lexer::get_string() { // NOLINT
                 break;
             }
             default:
-                error("Invalid escape character in string.");
+                return fail(ParseError::Kind::INVALID_ESCAPE);
             }
             break;
         case '\x22': // "
             next();
             return generate_token(Token::Type::STRING, std::move(s));
-        default:
-            s.push_back(*curr_pos);
-            break;
+        default: {
+            const auto *run = find_string_special(curr_pos, data_.end());
+            s.append(curr_pos, run);
+            next(static_cast<int>(run - curr_pos));
+            continue;
+        }
         }
         next();
     }
-    error("Unexpected end of string.");
+    return fail(ParseError::Kind::UNTERMINATED_STRING);
 }
 Token Lexer::get_number() { // NOLINT
     if (match("0") && !match("0.") && !match("0e")) {
         next();
-        return generate_token(Token::Type::NUMBER, 0);
+        return generate_token(Token::Type::NUMBER, int64_t{0});
     }
     if (match("-0") && !match("-0.") && !match("-0e")) {
         next(2);
         return generate_token(Token::Type::NUMBER, -0.0);
     }
+    // 整数快速路径: 没有小数和指数部分, 且在 int64/uint64 范围内
+    const auto *p = curr_pos;
+    bool negative = *p == '-';
+    if (negative) {
+        ++p;
+    }
+    const auto *digits = p;
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    while (p != data_.end() && *p >= '0' && *p <= '9') {
+        overflow |= __builtin_mul_overflow(magnitude, 10, &magnitude);
+        overflow |= __builtin_add_overflow(magnitude, *p - '0', &magnitude);
+        ++p;
+    }
+    if (p != digits && !overflow &&
+        (p == data_.end() || (*p != '.' && *p != 'e' && *p != 'E'))) {
+        constexpr auto int64_max =
+            static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+        if (!negative) {
+            curr_pos = p;
+            if (magnitude <= int64_max) {
+                return generate_token(Token::Type::NUMBER,
+                                      static_cast<int64_t>(magnitude));
+            }
+            return generate_token(Token::Type::NUMBER, magnitude);
+        }
+        if (magnitude <= int64_max + 1) {
+            curr_pos = p;
+            // -2^63 还在范围内, 经由 uint64_t 取反避免溢出
+            return generate_token(Token::Type::NUMBER,
+                                  static_cast<int64_t>(0 - magnitude));
+        }
+    }
     double retn{};
     auto result =
         from_chars(curr_pos, data_.end(), retn,
                    std::chars_format::general | std::chars_format::hex);
     if (result.ec == std::errc::invalid_argument) {
-        error("invalid float string");
+        return fail(ParseError::Kind::INVALID_NUMBER);
     } else if (result.ec == std::errc::result_out_of_range) {
-        error("result out of range");
+        return fail(ParseError::Kind::NUMBER_OUT_OF_RANGE);
     }
     const auto *iter = std::find(curr_pos, result.ptr, '.');
     if (iter != result.ptr && (iter[1] < '0' || iter[1] > '9')) {
-        error("Unexpected end of number");
+        return fail(ParseError::Kind::UNTERMINATED_NUMBER);
     }
     curr_pos = result.ptr;
     return generate_token(Token::Type::NUMBER, retn);
 }
-void Lexer::error(const char *messgae) const {
-    std::string message_ =
-        std::to_string(lineno) + ":" + std::to_string(colnom) + ": " + messgae;
-    throw std::runtime_error(message_);
+// Only checks the common shapes -?(0|[1-9]\d*)(\.\d+)?([eE][+-]?\d{1,2})?
+// up to 32 characters, which can't be out of range. Anything else (the
+// zero special cases, long numbers, big exponents, malformed input) goes
+// through get_number so the accepted numbers and errors stay the same.
+Token Lexer::get_raw_number() {
+    const auto *start = curr_pos;
+    const auto *end = data_.end();
+    const auto *p = start;
+    auto digits = [&]() {
+        const auto *from = p;
+        while (p != end && *p >= '0' && *p <= '9') {
+            ++p;
+        }
+        return p - from;
+    };
+    if (*p == '-') {
+        ++p;
+    }
+    const auto *integer = p;
+    auto integer_digits = digits();
+    bool simple = integer_digits != 0;
+    if (simple && *integer == '0') {
+        simple = integer_digits == 1 && p != end && (*p == '.' || *p == 'e');
+    }
+    if (simple && p != end && *p == '.') {
+        ++p;
+        simple = digits() != 0;
+    }
+    if (simple && p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        if (p != end && (*p == '+' || *p == '-')) {
+            ++p;
+        }
+        auto exponent_digits = digits();
+        simple = exponent_digits != 0 && exponent_digits <= 2;
+    }
+    if (simple && p - start <= 32) {
+        curr_pos = p;
+        return generate_token(Token::Type::NUMBER, std::string_view(start, p));
+    }
+    auto token = get_number();
+    if (error_) {
+        return token;
+    }
+    token.value = std::string_view(start, curr_pos);
+    return token;
+}
+Token Lexer::fail(ParseError::Kind kind) {
+    error_ = ParseError{kind, offset(), lineno, colnom};
+    curr_pos = data_.end();
+    if (structurals != nullptr) {
+        next_structural = structurals->size();
+    }
+    return generate_token(Token::Type::EOF_);
 }
 void Lexer::skip_ws() {
     while (curr_pos != data_.end()) {
@@ -322,112 +533,123 @@ std::vector<Token> Lexer::dump_tokens() {
     return tokens;
 }
 
-Json Parser::parse() {
-    auto json = parse_value();
-    if (curr()->type != Token::Type::EOF_) {
-        error("End of file expected");
+void Parser::parse(SaxHandler &handler) {
+    StatsTimer timer(stats, &ParseStats::parse_ns);
+    SaxParser sax(handler);
+    while (!sax.push(*curr())) {
+        next();
     }
-    return json;
 }
-// NOLINTBEGIN(*-no-recursion)
-Json Parser::parse_value() {
-    // curr != tokens_.end()
-
-    switch (curr()->type) {
-    case Token::Type::EOF_:
-    case Token::Type::END_ARRAY:
-    case Token::Type::END_OBJECT:
-    case Token::Type::NAME_SEPARATOR:
-    case Token::Type::VALUE_SEPARATOR:
-        error("Value expected");
-    case Token::Type::BEGIN_ARRAY:
-        return parse_array();
-    case Token::Type::BEGIN_OBJECT:
-        return parse_object();
-    case Token::Type::FALSE:
-        next();
-        return Json(false);
-    case Token::Type::TRUE:
-        next();
-        return Json(true);
-    case Token::Type::NULL_:
-        next();
-        return Json(Null{});
-    case Token::Type::NUMBER: {
-        auto json = Json(std::get<double>(curr()->value));
-        next();
-        return json;
+Json Parser::parse() {
+    DomBuilder builder(resource, stats);
+    parse(builder);
+    return std::move(builder.result());
+}
+// Each token is pushed as soon as it is lexed, so the lexer's offset is
+// still the end of the token a SaxParser error points at.
+std::optional<ParseError> Parser::try_parse(SaxHandler &handler) {
+    if (lexer == nullptr) {
+        throw std::logic_error("try_parse : needs a Lexer");
     }
-    case Token::Type::STRING: {
-        auto json = Json(std::get<std::string>(curr()->value));
-        next();
-        return json;
+    StatsTimer timer(stats, &ParseStats::parse_ns);
+    SaxParser sax(handler);
+    for (;;) {
+        auto token = lexer->try_next_token();
+        if (lexer->error()) [[unlikely]] {
+            return lexer->error();
+        }
+        if (sax.try_push(token)) {
+            break;
+        }
     }
+    if (auto error = sax.error()) [[unlikely]] {
+        error->offset = lexer->offset();
+        return error;
     }
-    unreachable();
+    return std::nullopt;
 }
-
-Json Parser::parse_array() {
-    // curr != tokens_.end()
-    Json json(ArrayType{});
-    if (curr(1)->type == Token::Type::END_ARRAY) {
-        next(2);
-        return json;
+ParseResult Parser::try_parse() {
+    DomBuilder builder(resource, stats);
+    if (auto error = try_parse(builder)) {
+        return *error;
     }
-    do { // NOLINT
-        next();
-        json.append(parse_value());
-    } while (curr()->type == Token::Type::VALUE_SEPARATOR);
-    if (curr()->type == Token::Type::END_ARRAY) {
-        next();
-        return json;
-    }
-    error("Expected comma or closing bracket");
+    return std::move(builder.result());
 }
-Json Parser::parse_object() {
-    Json json(ObjectType{});
-    if (curr(1)->type == Token::Type::END_OBJECT) {
-        next(2);
-        return json;
+
+namespace {
+// inline_parse minus its total_ns, for the fallbacks of parsers that
+// already time themselves
+Json parse_on_this_thread(std::string_view data,
+                          std::pmr::memory_resource *resource,
+                          ParseOptions options) {
+    Lexer lexer(data, options);
+    Parser parser(lexer, resource);
+    return parser.try_parse().value();
+}
+} // namespace
+
+Json indexed_parse(std::string_view data, std::pmr::memory_resource *resource,
+                   ParseOptions options) {
+    if (data.size() >= UINT32_MAX) {
+        return inline_parse(data, resource, options);
     }
-    do { // NOLINT
-        next();
-        if (curr()->type == Token::Type::STRING) {
-            auto index = std::get<std::string>(curr()->value);
-            if (json.contains(index)) {
-                error("Duplicate object key");
-            }
-            next();
-            if (curr()->type == Token::Type::NAME_SEPARATOR) {
-                next();
-                json[index] = parse_value();
-            } else {
-                error("Colon expected");
-            }
-        } else {
-            error("Property expected");
-        }
-    } while (curr()->type == Token::Type::VALUE_SEPARATOR);
-    if (curr()->type == Token::Type::END_OBJECT) {
-        next();
-        return json;
+    StatsTimer timer(options.stats, &ParseStats::total_ns);
+    auto index = build_structural_index(data);
+    try {
+        Lexer lexer(data, index, options);
+        Parser parser(lexer, resource);
+        return parser.parse();
+    } catch (const std::runtime_error & /*unused*/) {
+        // The indexed lexer doesn't track lines and columns; redo the failing
+        // document sequentially so the message is the same as inline_parse.
+        return parse_on_this_thread(data, resource, options);
     }
-    error("Expected comma or closing bracket");
 }
-// NOLINTEND(*-no-recursion)
 
-void Parser::error(const char *messgae) const {
-    std::string message_ = std::to_string(curr()->lineno) + ":" +
-                           std::to_string(curr()->col_offset) + ": " + messgae;
-    throw std::runtime_error(message_);
+Json inline_parse(std::string_view data, std::pmr::memory_resource *resource,
+                  ParseOptions options) {
+    StatsTimer timer(options.stats, &ParseStats::total_ns);
+    return parse_on_this_thread(data, resource, options);
+}
+ParseResult try_parse(std::string_view data,
+                      std::pmr::memory_resource *resource,
+                      ParseOptions options) {
+    StatsTimer timer(options.stats, &ParseStats::total_ns);
+    Lexer lexer(data, options);
+    Parser parser(lexer, resource);
+    return parser.try_parse();
+}
+
+Document parse_document(std::string_view data, size_t threshold,
+                        ParseOptions options) {
+    Document document{
+        std::make_unique<std::pmr::monotonic_buffer_resource>(
+            std::max<size_t>(data.size(), 1024)),
+        Json{}};
+    document.root =
+        threaded_parse(data, threshold, document.arena.get(), options);
+    return document;
+}
+
+Document parse_file(const std::string &path, size_t threshold,
+                    ParseOptions options) {
+    auto source = std::make_unique<MappedFile>(path);
+    auto document = parse_document(source->view(), threshold, options);
+    document.source = std::move(source);
+    return document;
 }
 
-Json threaded_parse(std::string_view data) {
-    Lexer lexer(data);
-    Parser parser;
-    std::promise<void> p;
-    std::future<void> f = p.get_future();
-    std::thread worker([&]() {
+Json threaded_parse(std::string_view data, size_t threshold,
+                    std::pmr::memory_resource *resource, ParseOptions options) {
+    if (data.size() < threshold) {
+        return inline_parse(data, resource, options);
+    }
+    StatsTimer timer(options.stats, &ParseStats::total_ns);
+    Lexer lexer(data, options);
+    TokenChannel channel(options.stats);
+    std::exception_ptr lexer_error;
+    std::latch lexer_done(1);
+    auto lex = [&]() {
         try {
             bool finish = false;
             while (!finish) {
@@ -435,35 +657,43 @@ Json threaded_parse(std::string_view data) {
                 if (token.type == Token::Type::EOF_) {
                     finish = true;
                 }
-                parser.push(std::move(token));
+                channel.push(std::move(token));
             }
         } catch (...) {
-            parser.stop = true;
-            parser.cv.notify_all();
-            try {
-                // 存储任何抛出的异常于 promise
-                p.set_exception(std::current_exception());
-            } catch(...) {} // set_exception() 亦可能抛出
-        }
-    });
-    Json value;
-    std::thread consumer([&]() {
-        try {
-            value = parser.parse();
-            p.set_value();
-        } catch (...) {
-            try {
-                // 存储任何抛出的异常于 promise
-                if(!parser.stop){
-                    p.set_exception(std::current_exception());
-                }
-            } catch(...) {} // set_exception() 亦可能抛出
+            // 若 parser 已先关闭队列, 这里只是被唤醒退出
+            if (!channel.closed()) {
+                lexer_error = std::current_exception();
+            }
+            // the tokens before the error go to the parser first, so an
+            // earlier grammar error is still the one reported
+            channel.close_write();
         }
-    });
-    consumer.join();
-    worker.join();
+        lexer_done.count_down();
+    };
+    if (!WorkerPool::instance().try_run(lex)) {
+        // 所有 worker 都在忙
+        return parse_on_this_thread(data, resource, options);
+    }
 
-    f.get();
+    Parser parser(channel, resource);
+    Json value;
+    std::exception_ptr parser_error;
+    try {
+        value = parser.parse();
+    } catch (int) { // lexer 出错并关闭了队列
+    } catch (...) {
+        parser_error = std::current_exception();
+        // 唤醒可能因队列已满而阻塞的 lexer
+        channel.close();
+    }
+    lexer_done.wait();
 
+    // lexer 出错前的 token 都已交给 parser, 所以 parser 的错误位置更靠前
+    if (parser_error) {
+        std::rethrow_exception(parser_error);
+    }
+    if (lexer_error) {
+        std::rethrow_exception(lexer_error);
+    }
     return value;
 }
\ No newline at end of file
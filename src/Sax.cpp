@@ -0,0 +1,263 @@
+#include "Sax.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+
+void SaxHandler::raw_number(std::string_view text) {
+    auto value = Json::parse_number(text);
+    if (const auto *i = value.get_if<int64_t>()) {
+        int64(*i);
+    } else if (const auto *u = value.get_if<uint64_t>()) {
+        uint64(*u);
+    } else {
+        number(*value.get_if<double>());
+    }
+}
+
+bool SaxParser::push(Token &token) {
+    bool done = try_push(token);
+    if (error_) [[unlikely]] {
+        throw std::runtime_error(error_->message());
+    }
+    return done;
+}
+bool SaxParser::try_push(Token &token) {
+    switch (state) {
+    case State::VALUE:
+        return value(token);
+    case State::ARRAY_FIRST:
+        if (token.type == Token::Type::END_ARRAY) {
+            containers.pop_back();
+            handler->end_array();
+            state = State::AFTER_VALUE;
+            return false;
+        }
+        return value(token);
+    case State::OBJECT_FIRST:
+        if (token.type == Token::Type::END_OBJECT) {
+            containers.pop_back();
+            handler->end_object();
+            state = State::AFTER_VALUE;
+            return false;
+        }
+        return key(token);
+    case State::KEY:
+        return key(token);
+    case State::COLON:
+        if (token.type != Token::Type::NAME_SEPARATOR) {
+            return fail(token, ParseError::Kind::COLON_EXPECTED);
+        }
+        state = State::VALUE;
+        return false;
+    case State::AFTER_VALUE:
+        if (containers.empty()) {
+            if (token.type != Token::Type::EOF_) {
+                return fail(token, ParseError::Kind::END_OF_FILE_EXPECTED);
+            }
+            state = State::DONE;
+            return true;
+        }
+        if (token.type == Token::Type::VALUE_SEPARATOR) {
+            state = containers.back() == Container::ARRAY ? State::VALUE
+                                                          : State::KEY;
+            return false;
+        }
+        if (containers.back() == Container::ARRAY &&
+            token.type == Token::Type::END_ARRAY) {
+            containers.pop_back();
+            handler->end_array();
+            return false;
+        }
+        if (containers.back() == Container::OBJECT &&
+            token.type == Token::Type::END_OBJECT) {
+            containers.pop_back();
+            handler->end_object();
+            return false;
+        }
+        return fail(token, ParseError::Kind::COMMA_OR_BRACKET_EXPECTED);
+    case State::DONE:
+        return true;
+    }
+    return true;
+}
+bool SaxParser::value(Token &token) {
+    state = State::AFTER_VALUE;
+    switch (token.type) {
+    case Token::Type::EOF_:
+    case Token::Type::END_ARRAY:
+    case Token::Type::END_OBJECT:
+    case Token::Type::NAME_SEPARATOR:
+    case Token::Type::VALUE_SEPARATOR:
+        return fail(token, ParseError::Kind::VALUE_EXPECTED);
+    case Token::Type::BEGIN_ARRAY:
+        containers.push_back(Container::ARRAY);
+        handler->start_array();
+        state = State::ARRAY_FIRST;
+        return false;
+    case Token::Type::BEGIN_OBJECT:
+        containers.push_back(Container::OBJECT);
+        handler->start_object();
+        state = State::OBJECT_FIRST;
+        return false;
+    case Token::Type::FALSE:
+        handler->boolean(false);
+        return false;
+    case Token::Type::TRUE:
+        handler->boolean(true);
+        return false;
+    case Token::Type::NULL_:
+        handler->null();
+        return false;
+    case Token::Type::NUMBER:
+        if (const auto *i = std::get_if<int64_t>(&token.value)) {
+            handler->int64(*i);
+        } else if (const auto *raw = std::get_if<std::string_view>(&token.value)) {
+            handler->raw_number(*raw);
+        } else if (const auto *u = std::get_if<uint64_t>(&token.value)) {
+            handler->uint64(*u);
+        } else {
+            handler->number(std::get<double>(token.value));
+        }
+        return false;
+    case Token::Type::STRING:
+        if (auto *view = std::get_if<std::string_view>(&token.value)) {
+            handler->string(*view);
+        } else {
+            handler->string(std::move(std::get<std::string>(token.value)));
+        }
+        return false;
+    }
+    return false;
+}
+bool SaxParser::key(Token &token) {
+    if (token.type != Token::Type::STRING) {
+        return fail(token, ParseError::Kind::PROPERTY_EXPECTED);
+    }
+    auto *view = std::get_if<std::string_view>(&token.value);
+    if (!(view != nullptr
+              ? handler->key(*view)
+              : handler->key(std::move(std::get<std::string>(token.value))))) {
+        return fail(token, ParseError::Kind::DUPLICATE_KEY);
+    }
+    state = State::COLON;
+    return false;
+}
+bool SaxParser::fail(const Token &token, ParseError::Kind kind) {
+    error_ = ParseError{kind, 0, token.lineno, token.col_offset};
+    state = State::DONE;
+    return true;
+}
+
+void DomBuilder::emit(Json value) {
+    if constexpr (stats_enabled) {
+        if (stats != nullptr) {
+            ++stats->nodes;
+        }
+    }
+    if (frames.empty()) {
+        root = std::move(value);
+    } else {
+        elements.push_back(std::move(value));
+    }
+}
+void DomBuilder::null() { emit(Json(Null{})); }
+void DomBuilder::boolean(bool value) { emit(Json(value)); }
+void DomBuilder::number(double value) { emit(Json(value)); }
+void DomBuilder::int64(int64_t value) { emit(Json(value)); }
+void DomBuilder::uint64(uint64_t value) { emit(Json(value)); }
+void DomBuilder::raw_number(std::string_view text) {
+    emit(Json(RawNumber{text}));
+}
+void DomBuilder::string(std::string_view value) {
+    emit(Json(BorrowedString{}, value));
+}
+void DomBuilder::string(std::string &&value) {
+    if constexpr (stats_enabled) {
+        if (stats != nullptr && value.size() > Json::small_capacity) {
+            stats->bytes_allocated += sizeof(void *) + value.size();
+        }
+    }
+    emit(Json(StringType{}, value, resource));
+}
+void DomBuilder::start_array() {
+    frames.push_back({Json(ArrayType{}, resource), elements.size(), 0, {}});
+    if constexpr (stats_enabled) {
+        if (stats != nullptr) {
+            stats->max_depth =
+                std::max<uint64_t>(stats->max_depth, frames.size());
+        }
+    }
+}
+void DomBuilder::end_array() {
+    auto frame = std::move(frames.back());
+    frames.pop_back();
+    auto &array = *frame.container.get_if<Json::arraytype>();
+    array.reserve(elements.size() - frame.base);
+    std::move(elements.begin() + static_cast<std::ptrdiff_t>(frame.base),
+              elements.end(), std::back_inserter(array));
+    elements.resize(frame.base);
+    if constexpr (stats_enabled) {
+        if (stats != nullptr) {
+            stats->bytes_allocated +=
+                sizeof(Json::arraytype) + array.capacity() * sizeof(Json);
+        }
+    }
+    emit(std::move(frame.container));
+}
+void DomBuilder::start_object() {
+    frames.push_back(
+        {Json(ObjectType{}, resource), elements.size(), keys.size(), {}});
+    if constexpr (stats_enabled) {
+        if (stats != nullptr) {
+            stats->max_depth =
+                std::max<uint64_t>(stats->max_depth, frames.size());
+        }
+    }
+}
+bool DomBuilder::key(std::string_view value) {
+    if (!pool) {
+        pool.reset(KeyPool::create());
+    }
+    auto interned = pool->intern(value);
+    auto &frame = frames.back();
+    auto first = keys.begin() + static_cast<std::ptrdiff_t>(frame.key_base);
+    // interned keys are equal exactly when their pointers are
+    if (static_cast<size_t>(keys.end() - first) < JsonObject::index_threshold) {
+        if (std::any_of(first, keys.end(), [&](std::string_view key) {
+                return key.data() == interned.data();
+            })) {
+            return false;
+        }
+    } else {
+        if (!frame.seen) {
+            frame.seen = std::make_unique<std::unordered_set<const char *>>();
+            for (auto it = first; it != keys.end(); ++it) {
+                frame.seen->insert(it->data());
+            }
+        }
+        if (!frame.seen->insert(interned.data()).second) {
+            return false;
+        }
+    }
+    keys.push_back(interned);
+    return true;
+}
+void DomBuilder::end_object() {
+    auto frame = std::move(frames.back());
+    frames.pop_back();
+    auto &object = *frame.container.get_if<Json::objecttype>();
+    object.assign(pool.get(), keys.data() + frame.key_base,
+                  elements.data() + frame.base, elements.size() - frame.base);
+    elements.resize(frame.base);
+    keys.resize(frame.key_base);
+    if constexpr (stats_enabled) {
+        if (stats != nullptr) {
+            stats->bytes_allocated +=
+                sizeof(Json::objecttype) + object.allocated_bytes();
+        }
+    }
+    emit(std::move(frame.container));
+}
@@ -0,0 +1,165 @@
+#include "Scan.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace {
+inline bool is_string_special(char ch) {
+    return ch == '\x22' || ch == '\x5C' || (ch >= '\0' && ch <= '\x1F');
+}
+// `[` and `]` differ from `{` and `}` only in bit 0x20.
+inline bool is_container_special(char ch) {
+    auto folded = static_cast<char>(ch | 0x20);
+    return ch == '\x22' || folded == '{' || folded == '}';
+}
+} // namespace
+
+const char *find_string_special_scalar(const char *begin, const char *end) {
+    while (begin != end && !is_string_special(*begin)) {
+        ++begin;
+    }
+    return begin;
+}
+
+const char *find_container_special_scalar(const char *begin,
+                                          const char *end) {
+    while (begin != end && !is_container_special(*begin)) {
+        ++begin;
+    }
+    return begin;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Control characters are found with an unsigned min: ch <= 0x1F exactly when
+// min(ch, 0x1F) == ch, which keeps bytes >= 0x80 (UTF-8) out of the match.
+__attribute__((target("sse2"))) const char *
+find_string_special_sse2(const char *begin, const char *end) {
+    const auto quote = _mm_set1_epi8('\x22');
+    const auto backslash = _mm_set1_epi8('\x5C');
+    const auto control = _mm_set1_epi8('\x1F');
+    while (end - begin >= 16) {
+        auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        auto special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                         _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+    return find_string_special_scalar(begin, end);
+}
+
+__attribute__((target("avx2"))) const char *
+find_string_special_avx2(const char *begin, const char *end) {
+    const auto quote = _mm256_set1_epi8('\x22');
+    const auto backslash = _mm256_set1_epi8('\x5C');
+    const auto control = _mm256_set1_epi8('\x1F');
+    while (end - begin >= 32) {
+        auto chunk =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        auto special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                            _mm256_cmpeq_epi8(chunk, backslash)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control), chunk));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+    // Stay in VEX code for the tail; jumping into the SSE2 version with
+    // dirty upper registers costs far more than the short scalar loop.
+    while (begin != end && !is_string_special(*begin)) {
+        ++begin;
+    }
+    return begin;
+}
+
+__attribute__((target("sse2"))) const char *
+find_container_special_sse2(const char *begin, const char *end) {
+    const auto quote = _mm_set1_epi8('\x22');
+    const auto fold = _mm_set1_epi8(0x20);
+    const auto open = _mm_set1_epi8('{');
+    const auto close = _mm_set1_epi8('}');
+    while (end - begin >= 16) {
+        auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        auto folded = _mm_or_si128(chunk, fold);
+        auto special = _mm_or_si128(
+            _mm_cmpeq_epi8(chunk, quote),
+            _mm_or_si128(_mm_cmpeq_epi8(folded, open),
+                         _mm_cmpeq_epi8(folded, close)));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+    return find_container_special_scalar(begin, end);
+}
+
+__attribute__((target("avx2"))) const char *
+find_container_special_avx2(const char *begin, const char *end) {
+    const auto quote = _mm256_set1_epi8('\x22');
+    const auto fold = _mm256_set1_epi8(0x20);
+    const auto open = _mm256_set1_epi8('{');
+    const auto close = _mm256_set1_epi8('}');
+    while (end - begin >= 32) {
+        auto chunk =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        auto folded = _mm256_or_si256(chunk, fold);
+        auto special = _mm256_or_si256(
+            _mm256_cmpeq_epi8(chunk, quote),
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, open),
+                            _mm256_cmpeq_epi8(folded, close)));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+    while (begin != end && !is_container_special(*begin)) {
+        ++begin;
+    }
+    return begin;
+}
+#endif
+
+namespace {
+using scan_fn = const char *(*)(const char *, const char *);
+scan_fn select_string_scanner() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return find_string_special_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return find_string_special_sse2;
+    }
+#endif
+    return find_string_special_scalar;
+}
+scan_fn select_container_scanner() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return find_container_special_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return find_container_special_sse2;
+    }
+#endif
+    return find_container_special_scalar;
+}
+} // namespace
+
+const char *find_string_special(const char *begin, const char *end) {
+    static const scan_fn scanner = select_string_scanner();
+    return scanner(begin, end);
+}
+const char *find_container_special(const char *begin, const char *end) {
+    static const scan_fn scanner = select_container_scanner();
+    return scanner(begin, end);
+}
@@ -0,0 +1,29 @@
+#include "Stats.hpp"
+#include "Reader.hpp"
+#include "json.hpp"
+#include <cstddef>
+#include <memory_resource>
+
+Json ParseStats::to_json() const {
+    auto *resource = std::pmr::get_default_resource();
+    Json tokens_by_type(ObjectType{}, resource);
+    for (size_t type = 0; type < token_types; ++type) {
+        tokens_by_type[Token{0, 0, static_cast<Token::Type>(type)}.get_type()] =
+            Json(tokens[type]);
+    }
+    Json ns(ObjectType{}, resource);
+    ns["lex"] = Json(lex_ns);
+    ns["parse"] = Json(parse_ns);
+    ns["total"] = Json(total_ns);
+    ns["lexer_wait"] = Json(lexer_wait_ns);
+    ns["parser_wait"] = Json(parser_wait_ns);
+
+    Json stats(ObjectType{}, resource);
+    stats["bytes_lexed"] = Json(bytes_lexed);
+    stats["tokens"] = std::move(tokens_by_type);
+    stats["ns"] = std::move(ns);
+    stats["nodes"] = Json(nodes);
+    stats["bytes_allocated"] = Json(bytes_allocated);
+    stats["max_depth"] = Json(max_depth);
+    return stats;
+}
@@ -0,0 +1,186 @@
+#include "Structural.hpp"
+#include <algorithm>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace {
+// Bit i of each mask describes byte i of a 64-byte block.
+struct BlockMasks {
+    uint64_t structural; // { } [ ] : ,
+    uint64_t whitespace;
+    uint64_t quote;
+    uint64_t backslash;
+};
+using classify_fn = BlockMasks (*)(const char *);
+
+BlockMasks classify_scalar(const char *block) {
+    BlockMasks masks{};
+    for (int i = 0; i < 64; ++i) {
+        auto bit = uint64_t{1} << i;
+        switch (block[i]) {
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ':':
+        case ',':
+            masks.structural |= bit;
+            break;
+        case '\x20':
+        case '\x09':
+        case '\x0A':
+        case '\x0D':
+            masks.whitespace |= bit;
+            break;
+        case '\x22':
+            masks.quote |= bit;
+            break;
+        case '\x5C':
+            masks.backslash |= bit;
+            break;
+        default:
+            break;
+        }
+    }
+    return masks;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2"))) uint64_t eq16(const __m128i *chunks,
+                                               char ch) {
+    auto c = _mm_set1_epi8(ch);
+    uint64_t mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        mask |= static_cast<uint64_t>(static_cast<uint16_t>(
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(chunks[i], c))))
+                << (16 * i);
+    }
+    return mask;
+}
+__attribute__((target("sse2"))) BlockMasks classify_sse2(const char *block) {
+    __m128i chunks[4];
+    for (int i = 0; i < 4; ++i) {
+        chunks[i] =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * i));
+    }
+    return {eq16(chunks, '{') | eq16(chunks, '}') | eq16(chunks, '[') |
+                eq16(chunks, ']') | eq16(chunks, ':') | eq16(chunks, ','),
+            eq16(chunks, '\x20') | eq16(chunks, '\x09') |
+                eq16(chunks, '\x0A') | eq16(chunks, '\x0D'),
+            eq16(chunks, '\x22'), eq16(chunks, '\x5C')};
+}
+
+__attribute__((target("avx2"))) uint64_t eq32(__m256i lo, __m256i hi,
+                                               char ch) {
+    auto c = _mm256_set1_epi8(ch);
+    auto low = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, c)));
+    auto high = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, c)));
+    return low | (static_cast<uint64_t>(high) << 32);
+}
+__attribute__((target("avx2"))) BlockMasks classify_avx2(const char *block) {
+    auto lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+    auto hi =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32));
+    return {eq32(lo, hi, '{') | eq32(lo, hi, '}') | eq32(lo, hi, '[') |
+                eq32(lo, hi, ']') | eq32(lo, hi, ':') | eq32(lo, hi, ','),
+            eq32(lo, hi, '\x20') | eq32(lo, hi, '\x09') |
+                eq32(lo, hi, '\x0A') | eq32(lo, hi, '\x0D'),
+            eq32(lo, hi, '\x22'), eq32(lo, hi, '\x5C')};
+}
+#endif
+
+classify_fn select_classifier() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return classify_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return classify_sse2;
+    }
+#endif
+    return classify_scalar;
+}
+
+// Bit i is set when byte i is escaped by an odd-length run of backslashes,
+// which may start in an earlier block.
+uint64_t find_escaped(uint64_t backslash, uint64_t &prev_escaped) {
+    constexpr uint64_t even_bits = 0x5555'5555'5555'5555ULL;
+    backslash &= ~prev_escaped;
+    uint64_t follows_escape = (backslash << 1) | prev_escaped;
+    uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+    uint64_t sequences_starting_on_even_bits{};
+    prev_escaped = __builtin_add_overflow(odd_sequence_starts, backslash,
+                                          &sequences_starting_on_even_bits)
+                       ? 1
+                       : 0;
+    uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+    return (even_bits ^ invert_mask) & follows_escape;
+}
+
+// Bit i = xor of bits 0..i, i.e. "inside a string" given the quote mask.
+uint64_t prefix_xor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+StructuralIndex build(std::string_view data, classify_fn classify) {
+    StructuralIndex index(std::max<size_t>(data.size() / 8, 64));
+    size_t count = 0;
+    uint64_t prev_escaped = 0;
+    uint64_t prev_in_string = 0; // all ones when the last block ended inside
+    uint64_t prev_scalar = 0;
+    char tail[64];
+    for (size_t base = 0; base < data.size(); base += 64) {
+        const char *block = data.data() + base;
+        if (data.size() - base < 64) {
+            std::memset(tail, '\x20', sizeof(tail));
+            std::memcpy(tail, block, data.size() - base);
+            block = tail;
+        }
+        auto masks = classify(block);
+
+        auto escaped = find_escaped(masks.backslash, prev_escaped);
+        auto quote = masks.quote & ~escaped;
+        // includes the opening quote, excludes the closing one
+        auto in_string = prefix_xor(quote) ^ prev_in_string;
+        prev_in_string = static_cast<uint64_t>(
+            -static_cast<int64_t>(in_string >> 63));
+
+        auto structural = masks.structural & ~in_string;
+        auto scalar =
+            ~(masks.structural | masks.whitespace | quote | in_string);
+        auto scalar_start = scalar & ~((scalar << 1) | prev_scalar);
+        prev_scalar = scalar >> 63;
+
+        auto bits = structural | (quote & in_string) | scalar_start;
+        if (count + 64 > index.size()) {
+            index.resize(index.size() * 2);
+        }
+        while (bits != 0) {
+            index[count++] =
+                static_cast<uint32_t>(base) + __builtin_ctzll(bits);
+            bits &= bits - 1;
+        }
+    }
+    index.resize(count);
+    return index;
+}
+} // namespace
+
+StructuralIndex build_structural_index(std::string_view data) {
+    static const classify_fn classify = select_classifier();
+    return build(data, classify);
+}
+StructuralIndex build_structural_index_scalar(std::string_view data) {
+    return build(data, classify_scalar);
+}
@@ -0,0 +1,333 @@
+#include "Tape.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr uint64_t end_mask = 0xFFFFFFFF; // start words: the end index
+
+template <class Integer> void integer(std::string &out, Integer integer) {
+    char buffer[24]; // NOLINT: 20 digits and a sign
+    auto p = std::to_chars(std::begin(buffer), std::end(buffer), integer);
+    out.append(std::begin(buffer), p.ptr);
+}
+} // namespace
+
+std::string_view Tape::string_at(uint64_t offset) const {
+    uint32_t length = 0;
+    std::memcpy(&length, strings.data() + offset, sizeof(length));
+    return {strings.data() + offset + sizeof(length), length};
+}
+
+size_t Tape::skip(size_t index) const {
+    switch (tag(index)) {
+    case Tag::BEGIN_ARRAY:
+    case Tag::BEGIN_OBJECT:
+        return payload(index) & end_mask;
+    case Tag::INT64:
+    case Tag::UINT64:
+    case Tag::DOUBLE:
+        return index + 2;
+    default:
+        return index + 1;
+    }
+}
+
+std::string Tape::dump(int size) const { return root().dump(size); }
+void Tape::dump_to(std::string &out, int size) const {
+    root().dump_to(out, size);
+}
+
+Json::Type TapeValue::get_type() const {
+    switch (tape->tag(index)) {
+    case Tape::Tag::NULL_:
+        return Json::Type::NULL_;
+    case Tape::Tag::TRUE:
+    case Tape::Tag::FALSE:
+        return Json::Type::BOOL_;
+    case Tape::Tag::STRING:
+        return Json::Type::STRING;
+    case Tape::Tag::BEGIN_ARRAY:
+        return Json::Type::ARRAY;
+    case Tape::Tag::BEGIN_OBJECT:
+        return Json::Type::OBJECT;
+    default:
+        return Json::Type::NUMBER;
+    }
+}
+
+void TapeValue::expect_container() const {
+    auto tag = tape->tag(index);
+    if (tag != Tape::Tag::BEGIN_ARRAY && tag != Tape::Tag::BEGIN_OBJECT) {
+        throw std::logic_error("only array and object have elements");
+    }
+}
+
+size_t TapeValue::size() const {
+    expect_container();
+    auto count = tape->payload(index) >> 32;
+    if (count < Tape::count_limit) {
+        return count;
+    }
+    // saturated: count the rest by skipping
+    return static_cast<size_t>(std::distance(begin(), end()));
+}
+
+TapeValue::Iterator TapeValue::begin() const {
+    expect_container();
+    return {*tape, index + 1, tape->tag(index) == Tape::Tag::BEGIN_OBJECT};
+}
+TapeValue::Iterator TapeValue::end() const {
+    expect_container();
+    return {*tape, tape->skip(index) - 1,
+            tape->tag(index) == Tape::Tag::BEGIN_OBJECT};
+}
+
+std::optional<TapeValue> TapeValue::find(std::string_view key) const {
+    if (tape->tag(index) != Tape::Tag::BEGIN_OBJECT) {
+        throw std::logic_error("only object can use string index");
+    }
+    for (auto it = begin(), last = end(); it != last; ++it) {
+        if (it.key() == key) {
+            return *it;
+        }
+    }
+    return std::nullopt;
+}
+std::optional<TapeValue> TapeValue::find(size_t index) const {
+    if (tape->tag(this->index) != Tape::Tag::BEGIN_ARRAY) {
+        throw std::logic_error("only array can use integer index");
+    }
+    if (index >= size()) {
+        return std::nullopt;
+    }
+    auto it = begin();
+    std::advance(it, index);
+    return *it;
+}
+TapeValue TapeValue::operator[](std::string_view key) const {
+    auto value = find(key);
+    if (!value) {
+        throw std::out_of_range("key not found");
+    }
+    return *value;
+}
+TapeValue TapeValue::operator[](size_t index) const {
+    auto value = find(index);
+    if (!value) {
+        throw std::out_of_range("index out of range");
+    }
+    return *value;
+}
+
+std::string TapeValue::dump(int size) const {
+    std::string out;
+    dump_to(out, size);
+    return out;
+}
+
+// One pass over the words, keeping only a bit per open container; the
+// layout matches Serializer's.
+void TapeValue::dump_to(std::string &out, int size) const {
+    using Tag = Tape::Tag;
+    auto newline = [&](size_t level) {
+        if (size != 0) {
+            out.push_back('\n');
+            out.append(size * level, ' ');
+        }
+    };
+    std::vector<bool> objects; // per open container
+    bool first = true;         // nothing written in this container yet
+    bool after_key = false;
+    for (size_t i = index, stop = tape->skip(index); i != stop;) {
+        auto tag = tape->tag(i);
+        if (tag == Tag::END_ARRAY || tag == Tag::END_OBJECT) {
+            objects.pop_back();
+            newline(objects.size());
+            out.push_back(tag == Tag::END_ARRAY ? ']' : '}');
+            first = false;
+            ++i;
+            continue;
+        }
+        if (!after_key && !objects.empty()) {
+            if (!first) {
+                out.push_back(',');
+            }
+            newline(objects.size());
+            if (objects.back()) {
+                dump_string_to(out, tape->string(i));
+                out.push_back(':');
+                if (size != 0) {
+                    out.push_back(' ');
+                }
+                after_key = true;
+                ++i;
+                continue;
+            }
+        }
+        after_key = false;
+        first = false;
+        switch (tag) {
+        case Tag::NULL_:
+            out.append("null");
+            break;
+        case Tag::TRUE:
+            out.append("true");
+            break;
+        case Tag::FALSE:
+            out.append("false");
+            break;
+        case Tag::INT64:
+            integer(out, static_cast<int64_t>(tape->next_word(i)));
+            break;
+        case Tag::UINT64:
+            integer(out, tape->next_word(i));
+            break;
+        case Tag::DOUBLE:
+            dump_number_to(out, std::bit_cast<double>(tape->next_word(i)));
+            break;
+        case Tag::STRING:
+            dump_string_to(out, tape->string(i));
+            break;
+        case Tag::BEGIN_ARRAY:
+        case Tag::BEGIN_OBJECT:
+            if (tape->skip(i) == i + 2) {
+                out.append(tag == Tag::BEGIN_ARRAY ? "[]" : "{}");
+                break;
+            }
+            out.push_back(tag == Tag::BEGIN_ARRAY ? '[' : '{');
+            objects.push_back(tag == Tag::BEGIN_OBJECT);
+            first = true;
+            ++i;
+            continue;
+        default:
+            break;
+        }
+        i = tape->skip(i);
+    }
+}
+
+size_t TapeBuilder::KeyHash::operator()(uint64_t offset) const {
+    return std::hash<std::string_view>{}(tape->string_at(offset));
+}
+bool TapeBuilder::KeyEqual::operator()(uint64_t lhs, uint64_t rhs) const {
+    return tape->string_at(lhs) == tape->string_at(rhs);
+}
+
+uint64_t TapeBuilder::append_string(std::string_view value) {
+    if (value.size() > UINT32_MAX) {
+        throw std::length_error("tape: string too long");
+    }
+    auto length = static_cast<uint32_t>(value.size());
+    auto offset = tape.strings.size();
+    tape.strings.resize(offset + sizeof(length) + length);
+    std::memcpy(tape.strings.data() + offset, &length, sizeof(length));
+    std::copy(value.begin(), value.end(),
+              tape.strings.begin() +
+                  static_cast<std::ptrdiff_t>(offset + sizeof(length)));
+    return offset;
+}
+
+void TapeBuilder::scalar(Tape::Tag tag, uint64_t bits) {
+    tape.words.push_back(Tape::word(tag, 0));
+    if (tag == Tape::Tag::INT64 || tag == Tape::Tag::UINT64 ||
+        tag == Tape::Tag::DOUBLE) {
+        tape.words.push_back(bits);
+    }
+    if (!frames.empty()) {
+        ++frames.back().count;
+    }
+}
+
+void TapeBuilder::null() { scalar(Tape::Tag::NULL_, 0); }
+void TapeBuilder::boolean(bool value) {
+    scalar(value ? Tape::Tag::TRUE : Tape::Tag::FALSE, 0);
+}
+void TapeBuilder::number(double value) {
+    scalar(Tape::Tag::DOUBLE, std::bit_cast<uint64_t>(value));
+}
+void TapeBuilder::int64(int64_t value) {
+    scalar(Tape::Tag::INT64, static_cast<uint64_t>(value));
+}
+void TapeBuilder::uint64(uint64_t value) {
+    scalar(Tape::Tag::UINT64, value);
+}
+void TapeBuilder::string(std::string_view value) {
+    tape.words.push_back(Tape::word(Tape::Tag::STRING, append_string(value)));
+    if (!frames.empty()) {
+        ++frames.back().count;
+    }
+}
+
+void TapeBuilder::start(Tape::Tag tag) {
+    frames.push_back({tape.words.size(), 0, keys.size(), nullptr});
+    tape.words.push_back(Tape::word(tag, 0));
+}
+void TapeBuilder::end(Tape::Tag tag) {
+    auto frame = std::move(frames.back());
+    frames.pop_back();
+    keys.resize(frame.key_base);
+    uint64_t end = tape.words.size() + 1;
+    if (end > end_mask) {
+        throw std::length_error("tape: document too large");
+    }
+    tape.words.push_back(Tape::word(tag, frame.start));
+    tape.words[frame.start] |=
+        end | (std::min(frame.count, Tape::count_limit) << 32);
+    if (!frames.empty()) {
+        ++frames.back().count;
+    }
+}
+void TapeBuilder::start_array() { start(Tape::Tag::BEGIN_ARRAY); }
+void TapeBuilder::end_array() { end(Tape::Tag::END_ARRAY); }
+void TapeBuilder::start_object() { start(Tape::Tag::BEGIN_OBJECT); }
+void TapeBuilder::end_object() { end(Tape::Tag::END_OBJECT); }
+
+bool TapeBuilder::key(std::string_view value) {
+    auto &frame = frames.back();
+    auto first = keys.begin() + static_cast<std::ptrdiff_t>(frame.key_base);
+    if (static_cast<size_t>(keys.end() - first) < JsonObject::index_threshold) {
+        if (std::any_of(first, keys.end(), [&](uint64_t key) {
+                return tape.string_at(key) == value;
+            })) {
+            return false;
+        }
+    }
+    auto offset = append_string(value);
+    if (static_cast<size_t>(keys.end() - first) >=
+        JsonObject::index_threshold) {
+        if (!frame.seen) {
+            frame.seen = std::make_unique<KeySet>(
+                0, KeyHash{&tape}, KeyEqual{&tape});
+            frame.seen->insert(first, keys.end());
+        }
+        if (!frame.seen->insert(offset).second) {
+            return false;
+        }
+    }
+    keys.push_back(offset);
+    tape.words.push_back(Tape::word(Tape::Tag::STRING, offset));
+    return true;
+}
+
+Tape Parser::parse_tape() {
+    TapeBuilder builder;
+    parse(builder);
+    return std::move(builder.result());
+}
+
+Tape tape_parse(std::string_view data, ParseOptions options) {
+    StatsTimer timer(options.stats, &ParseStats::total_ns);
+    // every string is copied into the tape, so none needs its own buffer
+    options.borrow_strings = true;
+    Lexer lexer(data, options);
+    Parser parser(lexer);
+    return parser.parse_tape();
+}
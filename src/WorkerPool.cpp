@@ -0,0 +1,58 @@
+#include "WorkerPool.hpp"
+#include <algorithm>
+#include <utility>
+
+WorkerPool::WorkerPool(size_t threads) {
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([this]() { work(); });
+    }
+}
+WorkerPool::~WorkerPool() {
+    {
+        std::unique_lock<std::mutex> lk(m);
+        stop = true;
+    }
+    cv.notify_all();
+    for (auto &&worker : workers) {
+        worker.join();
+    }
+}
+bool WorkerPool::try_run(std::function<void()> task) {
+    {
+        std::unique_lock<std::mutex> lk(m);
+        if (idle <= tasks.size()) {
+            return false;
+        }
+        tasks.emplace_back(std::move(task));
+    }
+    cv.notify_one();
+    return true;
+}
+void WorkerPool::run(std::function<void()> task) {
+    {
+        std::unique_lock<std::mutex> lk(m);
+        tasks.emplace_back(std::move(task));
+    }
+    cv.notify_one();
+}
+void WorkerPool::work() {
+    std::unique_lock<std::mutex> lk(m);
+    while (true) {
+        ++idle;
+        cv.wait(lk, [this]() { return stop || !tasks.empty(); });
+        --idle;
+        if (tasks.empty()) { // stop
+            return;
+        }
+        auto task = std::move(tasks.front());
+        tasks.pop_front();
+        lk.unlock();
+        task();
+        lk.lock();
+    }
+}
+WorkerPool &WorkerPool::instance() {
+    static WorkerPool pool(std::max(1U, std::thread::hardware_concurrency()));
+    return pool;
+}
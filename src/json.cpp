@@ -1,179 +1,482 @@
 #include "json.hpp"
+#include "Scan.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <charconv>
-#include <iomanip>
-#include <sstream>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <ostream>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
 
-template <> Json::Json(ArrayType /**/) : data(std::in_place_type<arraytype>) {}
-template <>
-Json::Json(ObjectType /**/) : data(std::in_place_type<objecttype>) {}
+static_assert(std::is_nothrow_move_constructible_v<Json>,
+              "vector growth must move elements, copies would leave the arena");
 
-const Json &Json::operator[](std::string index) const {
-    if (!std::holds_alternative<objecttype>(data)) {
+namespace {
+using ResourcePointer = std::pmr::memory_resource *;
+
+// Out-of-line values are allocated from `resource`; they free themselves
+// through the resource they remember.
+template <class T, class... Args>
+T *make(std::pmr::memory_resource *resource, Args &&...args) {
+    void *p = resource->allocate(sizeof(T), alignof(T));
+    return new (p) T(std::forward<Args>(args)...);
+}
+template <class T> void destroy(T *value) {
+    auto *resource = value->get_allocator().resource();
+    value->~T();
+    resource->deallocate(value, sizeof(T), alignof(T));
+}
+} // namespace
+
+Json::Json(Kind kind, const char *text, size_t length) {
+    if (length > UINT32_MAX) {
+        throw std::length_error("Json : string too long");
+    }
+    storage.large = {kind, static_cast<uint32_t>(length), {.text = text}};
+}
+Json::Json(StringType /**/, std::string_view value,
+           std::pmr::memory_resource *resource) {
+    if (value.size() <= small_capacity) {
+        storage.small.kind = Kind::SMALL_STRING;
+        storage.small.size = static_cast<uint8_t>(value.size());
+        std::copy(value.begin(), value.end(), storage.small.chars);
+        return;
+    }
+    if (value.size() > UINT32_MAX) {
+        throw std::length_error("Json : string too long");
+    }
+    auto *block = static_cast<char *>(resource->allocate(
+        sizeof(ResourcePointer) + value.size(), alignof(ResourcePointer)));
+    std::memcpy(block, &resource, sizeof(ResourcePointer));
+    std::memcpy(block + sizeof(ResourcePointer), value.data(), value.size());
+    storage.large = {Kind::STRING, static_cast<uint32_t>(value.size()),
+                     {.text = block + sizeof(ResourcePointer)}};
+}
+Json::Json(arraytype value) {
+    auto *resource = value.get_allocator().resource();
+    storage.large = {Kind::ARRAY, 0,
+                     {.array = make<arraytype>(resource, std::move(value))}};
+}
+Json::Json(objecttype value) {
+    auto *resource = value.get_allocator().resource();
+    storage.large = {Kind::OBJECT, 0,
+                     {.object = make<objecttype>(resource, std::move(value))}};
+}
+Json::Json(ArrayType /**/, std::pmr::memory_resource *resource) {
+    storage.large = {Kind::ARRAY, 0,
+                     {.array = make<arraytype>(resource, resource)}};
+}
+Json::Json(ObjectType /**/, std::pmr::memory_resource *resource) {
+    storage.large = {Kind::OBJECT, 0,
+                     {.object = make<objecttype>(resource, resource)}};
+}
+
+Json::Json(const Json &other) : storage(other.storage) {
+    auto *resource = std::pmr::get_default_resource();
+    switch (kind()) {
+    case Kind::STRING:
+        storage.large = {};
+        *this = Json(StringType{}, other.text(), resource);
+        break;
+    case Kind::ARRAY:
+        storage.large.value.array = make<arraytype>(
+            resource, *other.storage.large.value.array, resource);
+        break;
+    case Kind::OBJECT:
+        storage.large.value.object =
+            make<objecttype>(resource, *other.storage.large.value.object);
+        break;
+    default:
+        break;
+    }
+}
+Json &Json::operator=(const Json &other) {
+    if (this != &other) {
+        // other may live inside this value, so copy it first
+        *this = Json(other);
+    }
+    return *this;
+}
+Json &Json::operator=(Json &&other) noexcept {
+    if (this != &other) {
+        // the same goes for moves: take other before releasing this
+        auto taken = other.storage;
+        other.storage.large = {};
+        if (kind() >= Kind::STRING) {
+            release();
+        }
+        storage = taken;
+    }
+    return *this;
+}
+void Json::release() noexcept {
+    auto &value = storage.large.value;
+    switch (kind()) {
+    case Kind::STRING: {
+        const char *block = value.text - sizeof(ResourcePointer);
+        ResourcePointer resource = nullptr;
+        std::memcpy(&resource, block, sizeof(ResourcePointer));
+        resource->deallocate(const_cast<char *>(block), // NOLINT
+                             sizeof(ResourcePointer) + storage.large.length,
+                             alignof(ResourcePointer));
+        break;
+    }
+    case Kind::ARRAY:
+        destroy(value.array);
+        break;
+    case Kind::OBJECT:
+        destroy(value.object);
+        break;
+    default:
+        break;
+    }
+    storage.large = {};
+}
+
+const Json &Json::operator[](std::string_view key) const {
+    const auto *map = get_if<objecttype>();
+    if (map == nullptr) {
         throw std::logic_error("only object can use string index");
     }
-    const auto &map = std::get<objecttype>(data);
-    return map.at(index);
+    return map->at(key);
 }
-// NOLINTBEGIN(*-no-recursion)
-std::string array_print(const Json::arraytype &array, int size,
-                        size_t level = 0) {
-    if (array.empty()) {
-        return "[]";
-    }
-    std::stringstream s;
-    s << "[";
-    std::string newline = size == 0 ? "" : "\n";
-    std::string levels = newline + std::string(size * (level + 1), ' ');
-
-    bool first = true;
-    for (auto &&[_, v] : array) {
-        if (!first) {
-            s << ",";
+const Json *Json::find(std::string_view key) const {
+    const auto *map = get_if<objecttype>();
+    if (map == nullptr) {
+        throw std::logic_error("only object can use string index");
+    }
+    return map->find(key);
+}
+Json *Json::find(std::string_view key) {
+    return expect_object("only object can use string index").find(key);
+}
+Json::arraytype &Json::expect_array(const char *message) {
+    auto *array = get_if<arraytype>();
+    if (array == nullptr) {
+        throw std::logic_error(message);
+    }
+    return *array;
+}
+Json::objecttype &Json::expect_object(const char *message) {
+    auto *map = get_if<objecttype>();
+    if (map == nullptr) {
+        throw std::logic_error(message);
+    }
+    return *map;
+}
+namespace {
+// Writes a Json tree into one growing buffer. With a sink, the buffer is
+// handed over and reused whenever it passes flush_size, so memory stays
+// bounded no matter how big the tree is.
+class Serializer {
+  public:
+    using Sink = std::function<void(std::string_view)>;
+    constexpr static size_t flush_size = 64 * 1024;
+
+    Serializer(std::string &out, int size, Sink sink = {})
+        : out(out), size(size), sink(std::move(sink)) {}
+
+    void value(const Json &json, size_t level);
+    void finish() {
+        if (sink) {
+            sink(out);
+            out.clear();
         }
-        first = false;
-        s << levels << v.dump(size, level + 1);
-    }
-    s << newline << std::string(size * level, ' ') << "]";
-    return s.str();
-}
-
-std::string object_print(const Json::objecttype &map, int size,
-                         size_t level = 0) {
-    if (map.empty()) {
-        return "{}";
-    }
-    std::stringstream s;
-    s << "{";
-    std::string newline = size == 0 ? "" : "\n";
-    std::string space = size == 0 ? "" : " ";
-    std::string levels = newline + std::string(size * (level + 1), ' ');
-    bool first = true;
-    for (auto &&[k, v] : map) {
-        if (!first) {
-            s << ",";
+    }
+
+  private:
+    std::string &out;
+    int size;
+    Sink sink;
+
+    void newline(size_t level) {
+        if (size != 0) {
+            out.push_back('\n');
+            out.append(size * level, ' ');
         }
-        first = false;
-        s << levels << std::quoted(k) << ":" << space << v.dump(size, level + 1);
     }
-    s << newline << std::string(size * level, ' ') << "}";
-    return s.str();
-}
+    template <class Integer> void integer(Integer integer) {
+        char buffer[24]; // NOLINT: 20 digits and a sign
+        auto p = std::to_chars(std::begin(buffer), std::end(buffer), integer);
+        out.append(std::begin(buffer), p.ptr);
+    }
+};
 
-std::string Json::dump(int size, size_t level) const {
-    if (std::holds_alternative<Null>(data)) {
-        return "null";
+void escape(std::string &out, char ch) {
+    switch (ch) {
+    case '\x08':
+        out.append("\\b");
+        break;
+    case '\x09':
+        out.append("\\t");
+        break;
+    case '\x0A':
+        out.append("\\n");
+        break;
+    case '\x0C':
+        out.append("\\f");
+        break;
+    case '\x0D':
+        out.append("\\r");
+        break;
+    case '\0' ... '\x07':
+    case '\x0B':
+    case '\x0E' ... '\x1F': {
+        out.append("\\u00");
+        constexpr static const char alphabeta[] = "0123456789ABCDEF";
+        out.push_back(alphabeta[ch >> 4]);  // NOLINT
+        out.push_back(alphabeta[ch & 0xF]); // NOLINT
+        break;
+    }
+    case '\x22': // "
+    case '\x5C': /* \  */
+        out.push_back('\\');
+    default:
+        out.push_back(ch);
+        break;
     }
-    if (std::holds_alternative<bool>(data)) {
-        if (std::get<bool>(data)) {
-            return "true";
+}
+
+// NOLINTBEGIN(*-no-recursion)
+void Serializer::value(const Json &json, size_t level) {
+    switch (json.get_type()) {
+    case Json::Type::NULL_:
+        out.append("null");
+        break;
+    case Json::Type::BOOL_:
+        out.append(json.as<bool>() ? "true" : "false");
+        break;
+    case Json::Type::NUMBER:
+        if (const auto *i = json.get_if<int64_t>()) {
+            integer(*i);
+        } else if (const auto *u = json.get_if<uint64_t>()) {
+            integer(*u);
+        } else if (json.is<RawNumber>()) {
+            out.append(json.as<RawNumber>().text);
+        } else {
+            dump_number_to(out, *json.get_if<double>());
         }
-        return "false";
-    }
-    if (std::holds_alternative<double>(data)) {
-        std::string s(255, '\0');
-        auto number = std::get<double>(data);
-        auto p = std::to_chars(s.begin().base(), s.end().base(), number);
-        if (p.ec == std::errc::value_too_large) [[unlikely]] {
-            return std::to_string(number);
+        break;
+    case Json::Type::STRING:
+        dump_string_to(out, json.as<std::string_view>());
+        break;
+    case Json::Type::ARRAY: {
+        const auto &array = *json.get_if<Json::arraytype>();
+        if (array.empty()) {
+            out.append("[]");
+            break;
         }
-        s.resize(p.ptr - s.begin().base());
-        s.shrink_to_fit();
-        return s;
-    }
-    if (std::holds_alternative<std::string>(data)) {
-        std::string retn = "\"";
-        for (auto &&ch : std::get<std::string>(data)) {
-            switch (ch) {
-            case '\x08':
-                retn.append("\\b");
-                break;
-            case '\x09':
-                retn.append("\\t");
-                break;
-            case '\x0A':
-                retn.append("\\n");
-                break;
-            case '\x0C':
-                retn.append("\\f");
-                break;
-            case '\x0D':
-                retn.append("\\r");
-                break;
-            case '\0' ... '\x07':
-            case '\x0B':
-            case '\x0E' ... '\x19': {
-                retn.append("\\u00");
-                constexpr static const char alphabeta[] = "0123456789ABCDEF";
-                retn.push_back(alphabeta[ch >> 4]);  // NOLINT
-                retn.push_back(alphabeta[ch & 0xF]); // NOLINT
-                break;
+        out.push_back('[');
+        bool first = true;
+        for (auto &&v : array) {
+            if (!first) {
+                out.push_back(',');
             }
-            case '\x22': // "
-            case '\x5C': /* \  */
-                retn.push_back('\\');
-            default:
-                retn.push_back(ch);
-                break;
+            first = false;
+            newline(level + 1);
+            value(v, level + 1);
+        }
+        newline(level);
+        out.push_back(']');
+        break;
+    }
+    case Json::Type::OBJECT: {
+        const auto &map = *json.get_if<Json::objecttype>();
+        if (map.empty()) {
+            out.append("{}");
+            break;
+        }
+        out.push_back('{');
+        bool first = true;
+        for (auto &&[k, v] : map) {
+            if (!first) {
+                out.push_back(',');
+            }
+            first = false;
+            newline(level + 1);
+            dump_string_to(out, k);
+            out.push_back(':');
+            if (size != 0) {
+                out.push_back(' ');
             }
+            value(v, level + 1);
         }
-        return retn + "\"";
+        newline(level);
+        out.push_back('}');
+        break;
     }
-    if (std::holds_alternative<arraytype>(data)) {
-        auto map = std::get<arraytype>(data);
-        return array_print(map, size, level);
     }
-    if (std::holds_alternative<objecttype>(data)) {
-        auto map = std::get<objecttype>(data);
-        return object_print(map, size, level);
+    if (sink && out.size() >= flush_size) {
+        sink(out);
+        out.clear();
     }
-    return "";
 }
 // NOLINTEND(*-no-recursion)
-Json &Json::operator[](std::string index) {
-    if (!std::holds_alternative<objecttype>(data)) {
-        throw std::logic_error("only object can use string index");
+} // namespace
+
+void dump_number_to(std::string &out, double number) {
+    char buffer[32]; // NOLINT: shortest form of a double fits in 24
+    auto p = std::to_chars(std::begin(buffer), std::end(buffer), number);
+    out.append(std::begin(buffer), p.ptr);
+}
+
+void dump_write(int fd, std::string_view data) {
+    while (!data.empty()) {
+        auto written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("dump : ") +
+                                     std::strerror(errno));
+        }
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+}
+
+void dump_string_to(std::string &out, std::string_view string) {
+    out.push_back('"');
+    const char *p = string.data();
+    const char *end = string.data() + string.size();
+    while (p != end) {
+        const char *special = find_string_special(p, end);
+        out.append(p, special);
+        if (special == end) {
+            break;
+        }
+        escape(out, *special);
+        p = special + 1;
     }
-    auto &map = std::get<objecttype>(data);
-    return map[index];
+    out.push_back('"');
+}
+
+Json Json::parse_number(std::string_view text) {
+    const auto *end = text.data() + text.size();
+    int64_t i{};
+    auto result = std::from_chars(text.data(), end, i);
+    if (result.ec == std::errc{} && result.ptr == end) {
+        // "-0" stays a double, as in the lexer
+        return i == 0 && text.front() == '-' ? Json(-0.0) : Json(i);
+    }
+    uint64_t u{};
+    result = std::from_chars(text.data(), end, u);
+    if (result.ec == std::errc{} && result.ptr == end) {
+        return Json(u);
+    }
+    double d{};
+    result = std::from_chars(text.data(), end, d);
+    if (result.ec != std::errc{} || result.ptr != end) {
+        throw std::logic_error("parse_number : invalid number");
+    }
+    return Json(d);
+}
+bool Json::numbers_equal(const Json &lhs, const Json &rhs) {
+    bool l = lhs.is<RawNumber>();
+    bool r = rhs.is<RawNumber>();
+    if (l || r) {
+        return (l ? parse_number(lhs.text()) : lhs) ==
+               (r ? parse_number(rhs.text()) : rhs);
+    }
+    if (lhs.is<double>() || rhs.is<double>()) {
+        return lhs.as<double>() == rhs.as<double>();
+    }
+    if (lhs.kind() == rhs.kind()) {
+        return lhs.storage.large.value.uint64 == rhs.storage.large.value.uint64;
+    }
+    // one int64_t and one uint64_t
+    const auto &i = lhs.is<int64_t>() ? lhs : rhs;
+    const auto &u = lhs.is<int64_t>() ? rhs : lhs;
+    return std::cmp_equal(*i.get_if<int64_t>(), *u.get_if<uint64_t>());
+}
+bool operator==(const Json &lhs, const Json &rhs) {
+    auto type = lhs.get_type();
+    if (type != rhs.get_type()) {
+        return false;
+    }
+    switch (type) {
+    case Json::Type::NULL_:
+        return true;
+    case Json::Type::BOOL_:
+        return lhs.as<bool>() == rhs.as<bool>();
+    case Json::Type::NUMBER:
+        return Json::numbers_equal(lhs, rhs);
+    case Json::Type::STRING:
+        return lhs.text() == rhs.text();
+    case Json::Type::ARRAY:
+        return *lhs.get_if<Json::arraytype>() == *rhs.get_if<Json::arraytype>();
+    case Json::Type::OBJECT:
+        return *lhs.get_if<Json::objecttype>() ==
+               *rhs.get_if<Json::objecttype>();
+    }
+    return false;
+}
+
+std::string Json::dump(int size, size_t level) const {
+    std::string out;
+    Serializer(out, size).value(*this, level);
+    return out;
+}
+void Json::dump_to(std::string &out, int size) const {
+    Serializer(out, size).value(*this, 0);
+}
+void Json::dump_to(std::ostream &os, int size) const {
+    std::string buffer;
+    buffer.reserve(Serializer::flush_size * 2);
+    Serializer serializer(buffer, size, [&](std::string_view data) {
+        os.write(data.data(), static_cast<std::streamsize>(data.size()));
+    });
+    serializer.value(*this, 0);
+    serializer.finish();
+}
+void Json::dump_to(int fd, int size) const {
+    std::string buffer;
+    buffer.reserve(Serializer::flush_size * 2);
+    Serializer serializer(buffer, size,
+                          [&](std::string_view data) { dump_write(fd, data); });
+    serializer.value(*this, 0);
+    serializer.finish();
+}
+Json &Json::operator[](std::string_view key) {
+    return expect_object("only object can use string index")[key];
 }
 const Json &Json::operator[](size_t index) const {
-    if (!std::holds_alternative<arraytype>(data)) {
+    const auto *array = get_if<arraytype>();
+    if (array == nullptr) {
         throw std::logic_error("only array can use integer index");
     }
-    const auto &map = std::get<arraytype>(data);
-    if (index >= map.size()) {
+    if (index >= array->size()) {
         throw std::logic_error("index out of range");
     }
-    return map.at(index);
+    return (*array)[index];
 }
 Json &Json::operator[](size_t index) {
-    if (!std::holds_alternative<arraytype>(data)) {
+    auto *array = get_if<arraytype>();
+    if (array == nullptr) {
         throw std::logic_error("only array can use integer index");
     }
-    auto &map = std::get<arraytype>(data);
-    if (index > map.size()) {
+    if (index > array->size()) {
         throw std::logic_error("index out of range");
     }
-    return map[index];
-}
-void Json::append(Json json) {
-    if (!std::holds_alternative<arraytype>(data)) {
-        throw std::logic_error("only array can append");
+    if (index == array->size()) {
+        return array->emplace_back();
     }
-    auto &map = std::get<arraytype>(data);
-    map[map.size()] = json;
+    return (*array)[index];
 }
+// moving keeps the element's allocations, so arena-built children stay
+// in their arena
+Json &Json::append(Json &&value) { return emplace_back(std::move(value)); }
+Json &Json::append(const Json &value) { return emplace_back(value); }
 bool Json::contains(size_t index) const {
-    if (!std::holds_alternative<arraytype>(data)) {
+    const auto *array = get_if<arraytype>();
+    if (array == nullptr) {
         throw std::logic_error("only array can use integer index");
     }
-    const auto &map = std::get<arraytype>(data);
-    return index >= map.size();
+    return index >= array->size();
 }
-bool Json::contains(std::string index) const {
-    if (!std::holds_alternative<objecttype>(data)) {
-        throw std::logic_error("only object can use string index");
-    }
-    const auto &map = std::get<objecttype>(data);
-    return map.contains(index);
+bool Json::contains(std::string_view key) const {
+    return find(key) != nullptr;
 }
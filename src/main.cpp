@@ -1,21 +1,263 @@
+#include "Incremental.hpp"
+#include "MappedFile.hpp"
 #include "Reader.hpp"
+#include "Sax.hpp"
+#include "WorkerPool.hpp"
+#include <algorithm>
 #include <cstddef>
-#include <deque>
+#include <cstdlib>
 #include <exception>
-#include <format>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
-int main() {
-    std::string s;
-    while (std::getline(std::cin, s)) {
+namespace {
+// One document per input line, parsed while the line is still being read.
+struct LineParser {
+    std::pmr::monotonic_buffer_resource arena;
+    DomBuilder builder{&arena};
+    IncrementalParser parser{builder};
+    bool failed = false;
+
+    void feed(std::string_view piece) {
+        if (failed) {
+            return;
+        }
         try {
-            auto json = threaded_parse(s);
-            std::cout << json.dump() << "\n";
+            parser.feed(piece);
         } catch (const std::exception &ex) {
             std::cerr << ex.what() << "\n";
+            failed = true;
+        }
+    }
+    void finish() {
+        if (failed) {
+            return;
+        }
+        try {
+            parser.finish();
+            builder.result().dump_to(std::cout);
+            std::cout << "\n";
+        } catch (const std::exception &ex) {
+            std::cerr << ex.what() << "\n";
+        }
+    }
+};
+
+void run_sequential() {
+    constexpr size_t block_size = 64 * 1024;
+    std::vector<char> block(block_size);
+    auto line = std::make_unique<LineParser>();
+    bool open_line = false; // bytes fed since the last newline
+    while (std::cin.read(block.data(), block_size) || std::cin.gcount() > 0) {
+        std::string_view data(block.data(),
+                              static_cast<size_t>(std::cin.gcount()));
+        while (!data.empty()) {
+            auto newline = data.find('\n');
+            line->feed(data.substr(0, newline));
+            open_line = true;
+            if (newline == std::string_view::npos) {
+                break;
+            }
+            line->finish();
+            line = std::make_unique<LineParser>();
+            open_line = false;
+            data.remove_prefix(newline + 1);
+        }
+    }
+    if (open_line) {
+        line->finish();
+    }
+}
+
+// Parses complete lines on `jobs` threads and prints the results in input
+// order. Errors carry the input line number.
+class BatchRunner {
+  public:
+    BatchRunner(size_t jobs, ParseOptions options)
+        : pool(jobs - 1), options(options) {}
+
+    // Handles every complete line of `data` (and a trailing partial one if
+    // `last`); returns how many bytes were consumed.
+    size_t feed(std::string_view data, bool last) {
+        lines.clear();
+        auto rest = data;
+        for (auto newline = rest.find('\n'); newline != std::string_view::npos;
+             newline = rest.find('\n')) {
+            lines.push_back(rest.substr(0, newline));
+            rest.remove_prefix(newline + 1);
+        }
+        if (last && !rest.empty()) {
+            lines.push_back(rest);
+            rest = {};
+        }
+
+        outputs.assign(lines.size(), Output{});
+        pool.parallel_for(lines.size(), [&](size_t i) {
+            thread_local std::pmr::monotonic_buffer_resource arena;
+            try {
+                Lexer lexer(lines[i], static_cast<int>(lines_before + i + 1),
+                            1, options);
+                Parser parser(lexer, &arena);
+                // malformed lines are common enough to keep off the
+                // exception path
+                if (auto result = parser.try_parse()) {
+                    result->dump_to(outputs[i].text);
+                } else {
+                    outputs[i] = Output{result.error().message(), true};
+                }
+            } catch (const std::exception &ex) {
+                outputs[i] = Output{ex.what(), true};
+            }
+            arena.release();
+        });
+        for (auto &&output : outputs) {
+            (output.failed ? std::cerr : std::cout) << output.text << "\n";
+        }
+        lines_before += lines.size();
+        return data.size() - rest.size();
+    }
+
+  private:
+    struct Output {
+        std::string text;
+        bool failed = false;
+    };
+    WorkerPool pool;
+    ParseOptions options;
+    std::vector<std::string_view> lines;
+    std::vector<Output> outputs;
+    size_t lines_before = 0;
+};
+
+constexpr size_t batch_block_size = 4 * 1024 * 1024;
+
+void run_batch(size_t jobs, ParseOptions options) {
+    BatchRunner runner(jobs, options);
+    std::string buffer;
+    bool eof = false;
+    while (!eof) {
+        auto carried = buffer.size();
+        buffer.resize(carried + batch_block_size);
+        std::cin.read(buffer.data() + carried, batch_block_size);
+        buffer.resize(carried + static_cast<size_t>(std::cin.gcount()));
+        eof = !std::cin;
+        buffer.erase(0, runner.feed(buffer, eof));
+    }
+}
+
+// The mapping is walked in windows so that at most one window of results is
+// held at a time; a window grows when a single line doesn't fit in it.
+void run_batch(size_t jobs, ParseOptions options, const MappedFile &file) {
+    BatchRunner runner(jobs, options);
+    auto data = file.view();
+    auto window = batch_block_size;
+    while (!data.empty()) {
+        bool last = data.size() <= window;
+        auto consumed = runner.feed(data.substr(0, window), last);
+        if (consumed == 0 && !last) {
+            window *= 2;
+            continue;
         }
+        window = batch_block_size;
+        data.remove_prefix(consumed);
     }
+}
+
+// A file argument without --batch is one (possibly huge) document.
+int run_document(const std::string &path, ParseOptions options) {
+    try {
+        auto document = parse_file(path, inline_parse_threshold, options);
+        document.root.dump_to(std::cout);
+        std::cout << "\n";
+        if (options.stats != nullptr) {
+            std::cerr << options.stats->to_json().dump() << "\n";
+        }
+    } catch (const std::exception &ex) {
+        std::cerr << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+void usage() {
+    std::cerr << "usage: json-parser [--batch | --jobs N] [--raw-numbers] "
+                 "[--stats] [FILE]\n"
+                 "  FILE      mapped instead of read; one document unless "
+                 "--batch\n"
+                 "  --batch   parse lines on all cores, output in input order\n"
+                 "  --jobs N  like --batch with N threads\n"
+                 "  --raw-numbers  print numbers exactly as written (with "
+                 "--batch or FILE);\n"
+                 "            strings are borrowed from the input too\n"
+                 "  --stats   print parse statistics of FILE to stderr as "
+                 "JSON (builds\n"
+                 "            with JSON_PARSER_STATS only)\n";
+}
+} // namespace
 
+int main(int argc, char **argv) {
+    std::ios::sync_with_stdio(false);
+    size_t jobs = 0; // 0: sequential
+    ParseOptions options;
+    ParseStats stats;
+    std::string path;
+    std::vector<std::string_view> args(argv + 1, argv + argc);
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--batch") {
+            jobs = std::max(1U, std::thread::hardware_concurrency());
+        } else if (args[i] == "--jobs" && i + 1 < args.size()) {
+            jobs = std::strtoul(args[++i].data(), nullptr, 10);
+            if (jobs == 0) {
+                usage();
+                return 1;
+            }
+        } else if (args[i] == "--raw-numbers") {
+            // batch lines and mapped files outlive their Json
+            options.borrow_strings = true;
+            options.raw_numbers = true;
+        } else if (args[i] == "--stats") {
+            if (!stats_enabled) {
+                std::cerr << "--stats: built without JSON_PARSER_STATS\n";
+                return 1;
+            }
+            options.stats = &stats;
+        } else if (path.empty() && !args[i].starts_with("-")) {
+            path = args[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (options.stats != nullptr && (path.empty() || jobs != 0)) {
+        usage(); // only one document is parsed with the Lexer and Parser
+        return 1;
+    }
+    if (options.raw_numbers && path.empty() && jobs == 0) {
+        usage(); // stdin lines are fed incrementally, with default options
+        return 1;
+    }
+    if (path.empty()) {
+        if (jobs == 0) {
+            run_sequential();
+        } else {
+            run_batch(jobs, options);
+        }
+        return 0;
+    }
+    if (jobs == 0) {
+        return run_document(path, options);
+    }
+    try {
+        MappedFile file(path);
+        run_batch(jobs, options, file);
+    } catch (const std::exception &ex) {
+        std::cerr << ex.what() << "\n";
+        return 1;
+    }
     return 0;
 }
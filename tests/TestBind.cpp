@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include "Bind.hpp"
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+struct Address {
+    std::string city;
+    uint16_t zip = 0;
+};
+struct Person {
+    int64_t id = 0;
+    std::string name;
+    double score = 0;
+    bool active = false;
+    std::vector<std::string> tags;
+    std::optional<Address> address;
+    Json extra;
+};
+} // namespace
+
+template <>
+constexpr auto json_fields<Address> =
+    std::tuple{JSON_FIELD(Address, city), JSON_FIELD(Address, zip)};
+template <>
+constexpr auto json_fields<Person> = std::tuple{
+    JSON_FIELD(Person, id),     JSON_FIELD(Person, name),
+    JSON_FIELD(Person, score),  JSON_FIELD(Person, active),
+    JSON_FIELD(Person, tags),   JSON_FIELD(Person, address),
+    JSON_FIELD(Person, extra)};
+
+// NOLINTBEGIN
+TEST(BindTest, read_and_write) {
+    std::string input = R"([
+        {"id": 7, "name": "Ann \"A\"", "score": 1.5, "active": true,
+         "tags": ["a", "b"], "unknown": {"x": [1, {"y": null}]},
+         "address": {"zip": 12345, "city": "Paris"}, "extra": [1, {"k": "v"}]},
+        {"id": -1, "address": null, "score": 2}
+    ])";
+    for (auto options : {ParseOptions{}, ParseOptions{.borrow_strings = true,
+                                                      .raw_numbers = true}}) {
+        auto people = parse_into<std::vector<Person>>(input, options);
+        ASSERT_EQ(people.size(), 2);
+        EXPECT_EQ(people[0].id, 7);
+        EXPECT_EQ(people[0].name, "Ann \"A\"");
+        EXPECT_EQ(people[0].score, 1.5);
+        EXPECT_TRUE(people[0].active);
+        EXPECT_EQ(people[0].tags, (std::vector<std::string>{"a", "b"}));
+        ASSERT_TRUE(people[0].address);
+        EXPECT_EQ(people[0].address->city, "Paris");
+        EXPECT_EQ(people[0].address->zip, 12345);
+        EXPECT_EQ(people[0].extra, inline_parse(R"([1, {"k": "v"}])"));
+        EXPECT_EQ(people[1].id, -1);
+        EXPECT_EQ(people[1].score, 2);
+        EXPECT_FALSE(people[1].address);
+        EXPECT_EQ(people[1].extra, Json());
+    }
+
+    auto people = parse_into<std::vector<Person>>(input);
+    auto text = dump_struct(people);
+    EXPECT_EQ(
+        text,
+        R"([{"id":7,"name":"Ann \"A\"","score":1.5,"active":true,"tags":["a","b"],)"
+        R"("address":{"city":"Paris","zip":12345},"extra":[1,{"k":"v"}]},)"
+        R"({"id":-1,"name":"","score":2,"active":false,"tags":[],)"
+        R"("address":null,"extra":null}])");
+    EXPECT_EQ(dump_struct(parse_into<std::vector<Person>>(text)), text);
+}
+TEST(BindTest, errors) {
+    auto message = [](std::string_view input) {
+        try {
+            parse_into<Person>(input);
+        } catch (const std::runtime_error &ex) {
+            return std::string(ex.what());
+        }
+        return std::string();
+    };
+    EXPECT_EQ(message(R"({"id": 1.5})"), "1:8: Integer expected");
+    EXPECT_EQ(message(R"({"id": "1"})"), "1:11: Integer expected");
+    EXPECT_EQ(message(R"({"address": {"zip": 70000}})"),
+              "1:21: Integer out of range");
+    // the rest read the same as inline_parse's
+    EXPECT_EQ(message(R"({"id": 1, "id": 2})"), "1:14: Duplicate object key");
+    EXPECT_EQ(message(R"({"x": 1, "x": 2})"), "1:12: Duplicate object key");
+    EXPECT_EQ(message(R"({"extra": 1, "unknown": {"x": 1, "x": 2}})"),
+              "1:35: Duplicate object key");
+    EXPECT_EQ(message(R"({"tags": ["a" "b"]})"),
+              "1:18: Expected comma or closing bracket");
+    EXPECT_EQ(message(R"({"unknown": [1 2]})"),
+              "1:15: Expected comma or closing bracket");
+    EXPECT_EQ(message(R"({"name" 1})"), "1:9: Colon expected");
+    EXPECT_EQ(message(R"([])"), "1:2: Object expected");
+    EXPECT_EQ(message(R"({} 1)"), "1:4: End of file expected");
+}
+// NOLINTEND
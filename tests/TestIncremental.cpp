@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "Incremental.hpp"
+#include <string>
+
+namespace {
+// Parses `doc` fed in chunks of `size` bytes; the dump or the error.
+std::string feed_in_chunks(std::string_view doc, size_t size) {
+    DomBuilder builder;
+    IncrementalParser parser(builder);
+    try {
+        for (size_t i = 0; i < doc.size(); i += size) {
+            parser.feed(doc.substr(i, size));
+        }
+        parser.finish();
+        return builder.result().dump(0);
+    } catch (const std::runtime_error &ex) {
+        return std::string("ERR ") + ex.what();
+    }
+}
+std::string parse_whole(std::string_view doc) {
+    try {
+        return inline_parse(doc).dump(0);
+    } catch (const std::runtime_error &ex) {
+        return std::string("ERR ") + ex.what();
+    }
+}
+} // namespace
+
+// NOLINTBEGIN
+TEST(IncrementalTest, any_split) {
+    std::string doc = "{\"emoji\": \"\\uD83E\\uDD70 \\\"q\\\" \\\\\",\n"
+                      " \"nums\": [-12.5e-3, 0, 123456789, true, false, null],\n"
+                      " \"nested\": {\"a\": [[], {}], \"b\": \"long string\"}}";
+    auto expected = parse_whole(doc);
+    for (size_t size = 1; size <= doc.size(); ++size) {
+        EXPECT_EQ(feed_in_chunks(doc, size), expected) << size;
+    }
+}
+TEST(IncrementalTest, errors_match_whole_document) {
+    for (std::string doc : {"[1,\n 2 3]", "{\"a\":\n\"b\\x\"}", "[tru]",
+                            "[1,2", "{\"k\": 1,}", "\"open", "[1]\n]", ""}) {
+        auto expected = parse_whole(doc);
+        for (size_t size = 1; size <= doc.size(); ++size) {
+            EXPECT_EQ(feed_in_chunks(doc, size), expected) << doc << size;
+        }
+    }
+}
+// NOLINTEND
@@ -0,0 +1,343 @@
+#include <gtest/gtest.h>
+
+#include "Reader.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace {
+// operator new calls made by this thread
+thread_local size_t heap_allocations = 0;
+} // namespace
+
+// GCC sees malloc'd memory reach free() through the inlined operator delete
+// and takes it for a new/free mismatch; these replacements pair them up.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void *operator new(size_t size) {
+    ++heap_allocations;
+    if (void *p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+// std::pmr::new_delete_resource allocates through this one
+void *operator new(size_t size, std::align_val_t align) {
+    ++heap_allocations;
+    auto alignment = static_cast<size_t>(align);
+    size = (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    if (void *p = std::aligned_alloc(alignment, size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+// Bytes currently taken from new_delete_resource.
+class CountingResource : public std::pmr::memory_resource {
+  public:
+    long live = 0;
+
+  private:
+    void *do_allocate(size_t size, size_t alignment) override {
+        live += static_cast<long>(size);
+        return std::pmr::new_delete_resource()->allocate(size, alignment);
+    }
+    void do_deallocate(void *p, size_t size, size_t alignment) override {
+        live -= static_cast<long>(size);
+        std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+    }
+    bool do_is_equal(const memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+};
+} // namespace
+
+// NOLINTBEGIN
+TEST(JsonTest, dump) {
+    Json array(ArrayType{});
+    array.append(Json(1.5));
+    array.append(Json(std::string("a\"b\\c\x01\t")));
+    array.append(Json(ArrayType{}));
+    Json object(ObjectType{});
+    object["k"] = Json(true);
+    array.append(std::move(object));
+    array.append(Json(Null{}));
+    EXPECT_EQ(array.dump(0), R"([1.5,"a\"b\\c\u0001\t",[],{"k":true},null])");
+    // every control character is escaped, also past the vectorized runs
+    EXPECT_EQ(Json(std::string("a\x1F" "b")).dump(0), R"("a\u001Fb")");
+    std::string run(40, 'x');
+    EXPECT_EQ(Json(run + "\x1A" + run).dump(0),
+              "\"" + run + "\\u001A" + run + "\"");
+    EXPECT_EQ(array.dump(2), "[\n"
+                             "  1.5,\n"
+                             "  \"a\\\"b\\\\c\\u0001\\t\",\n"
+                             "  [],\n"
+                             "  {\n"
+                             "    \"k\": true\n"
+                             "  },\n"
+                             "  null\n"
+                             "]");
+}
+TEST(JsonTest, dump_to_matches_dump) {
+    std::string doc = "[";
+    for (int i = 0; i < 5000; ++i) {
+        doc += R"({"id":)" + std::to_string(i) +
+               R"(,"name":"record \"quoted\" line\n","ok":[true,null]},)";
+    }
+    doc += "{}]";
+    auto json = inline_parse(doc);
+    for (int size : {0, 4}) {
+        auto expected = json.dump(size);
+        std::string out = "prefix";
+        json.dump_to(out, size);
+        EXPECT_EQ(out, "prefix" + expected);
+        std::ostringstream os;
+        json.dump_to(os, size);
+        EXPECT_EQ(os.str(), expected);
+    }
+}
+TEST(JsonTest, exact_integers) {
+    auto json = inline_parse("[9007199254740993,-9223372036854775808,"
+                             "18446744073709551615,1.0,1]");
+    EXPECT_EQ(json.dump(0), "[9007199254740993,-9223372036854775808,"
+                            "18446744073709551615,1,1]");
+    EXPECT_EQ(json[0].as<int64_t>(), 9007199254740993);
+    EXPECT_EQ(json[0].as<uint64_t>(), 9007199254740993U);
+    EXPECT_EQ(json[1].as<int64_t>(), std::numeric_limits<int64_t>::min());
+    EXPECT_THROW(json[1].as<uint64_t>(), std::logic_error);
+    EXPECT_EQ(json[2].as<uint64_t>(), std::numeric_limits<uint64_t>::max());
+    EXPECT_THROW(json[2].as<int64_t>(), std::logic_error);
+    EXPECT_THROW(json[3].as<int64_t>(), std::logic_error);
+    EXPECT_DOUBLE_EQ(json[4].as<double>(), 1.0);
+    EXPECT_EQ(json[3], json[4]);
+    EXPECT_EQ(json[4].get_type(), Json::Type::NUMBER);
+    EXPECT_NE(Json(int64_t{-1}), Json(std::numeric_limits<uint64_t>::max()));
+}
+TEST(JsonTest, compact_nodes) {
+    EXPECT_EQ(sizeof(Json), 16);
+    CountingResource counting;
+    {
+        Json small(StringType{}, "fourteen bytes", &counting);
+        EXPECT_EQ(counting.live, 0);
+        EXPECT_EQ(small.as<std::string_view>(), "fourteen bytes");
+        EXPECT_TRUE(small.is<std::string>());
+        Json large(StringType{}, "fifteen bytes..", &counting);
+        EXPECT_GT(counting.live, 0);
+        EXPECT_EQ(large.as<std::string>(), "fifteen bytes..");
+
+        Json copy = large; // from the default resource
+        auto live = counting.live;
+        EXPECT_EQ(copy, large);
+        EXPECT_NE(copy.as<std::string_view>().data(),
+                  large.as<std::string_view>().data());
+        Json moved = std::move(large);
+        EXPECT_TRUE(large.is<Null>());
+        EXPECT_EQ(moved, copy);
+        EXPECT_EQ(counting.live, live);
+
+        std::string text = "borrowed, not copied";
+        Json borrowed(BorrowedString{}, text);
+        EXPECT_EQ(borrowed.as<std::string_view>().data(), text.data());
+        EXPECT_TRUE(borrowed.is<std::string_view>());
+        EXPECT_EQ(borrowed, Json(text));
+        // only the tag borrows: a view or a literal is copied
+        Json copied{std::string_view(text)};
+        EXPECT_NE(copied.as<std::string_view>().data(), text.data());
+        EXPECT_TRUE(copied.is<std::string>());
+        const char *literal = "abc";
+        Json abc("abc");
+        EXPECT_NE(abc.as<std::string_view>().data(), literal);
+        EXPECT_TRUE(abc.is<std::string>());
+        EXPECT_EQ(abc.as<std::string>(), "abc");
+    }
+    EXPECT_EQ(counting.live, 0);
+
+    // containers live out of line, in their own resource
+    {
+        Json array(ArrayType{}, &counting);
+        array.append(Json(int64_t{1}));
+        array.append(Json(StringType{}, "a string longer than 14", &counting));
+        EXPECT_EQ(array.as<Json::arraytype>().get_allocator().resource(),
+                  &counting);
+        EXPECT_EQ(array.dump(0), R"([1,"a string longer than 14"])");
+    }
+    EXPECT_EQ(counting.live, 0);
+
+    // assigning a value its own child
+    auto json = inline_parse(
+        R"({"a": {"b": ["a string longer than 14", {"c": null}]}})");
+    json = std::move(json["a"]);
+    EXPECT_EQ(json.dump(0), R"({"b":["a string longer than 14",{"c":null}]})");
+    json = json["b"];
+    EXPECT_EQ(json.dump(0), R"(["a string longer than 14",{"c":null}])");
+    EXPECT_EQ(*json[1].get_if<Json::objecttype>()->find("c"), Json(Null{}));
+    EXPECT_EQ(json.get_if<Json::objecttype>(), nullptr);
+}
+TEST(JsonTest, no_allocations) {
+    auto document = parse_document(
+        R"({"name": "a string longer than 14", "list": [1, {"k": true}],
+            "n": 2})");
+    auto &root = document.root;
+    const auto &view = root;
+    std::array<std::byte, 1024> buffer;
+    std::pmr::monotonic_buffer_resource arena(
+        buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    Json array(ArrayType{}, &arena);
+    array.get_if<Json::arraytype>()->reserve(4);
+
+    auto before = heap_allocations;
+    // lookups take views: no key is copied into a std::string
+    bool contains = view.contains("name") && !view.contains("missing");
+    auto name = view["name"].as<std::string_view>();
+    bool k = view["list"][1]["k"].as<bool>();
+    bool found = view.find("n") != nullptr && root.find("missing") == nullptr;
+    // moves keep their allocations, wherever they came from
+    Json list = std::move(root["list"]);
+    root["n"] = std::move(list);
+    array.append(std::move(root["n"]));
+    array.emplace_back(int64_t{3});
+    bool inserted = root.insert("name", Json(1.5)).second;
+    auto after = heap_allocations;
+
+    EXPECT_EQ(after, before);
+    EXPECT_TRUE(contains);
+    EXPECT_EQ(name, "a string longer than 14");
+    EXPECT_TRUE(k);
+    EXPECT_TRUE(found);
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(root.dump(0),
+              R"({"name":"a string longer than 14","list":null,"n":null})");
+    EXPECT_EQ(array.dump(0), R"([[1,{"k":true}],3])");
+    Json copy = view["name"]; // copies do allocate
+    EXPECT_GT(heap_allocations, after);
+}
+TEST(JsonTest, emplace_and_insert) {
+    Json object(ObjectType{});
+    auto [value, inserted] = object.emplace("a", int64_t{1});
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(*value, Json(int64_t{1}));
+    Json two(int64_t{2});
+    EXPECT_FALSE(object.insert("a", two).second);
+    EXPECT_TRUE(object.insert("b", std::move(two)).second);
+    // the value may be one of the object's own members
+    for (int i = 0; i < 40; ++i) {
+        object.insert("c" + std::to_string(i), object["a"]);
+    }
+    EXPECT_EQ(object["c39"], Json(int64_t{1}));
+    EXPECT_EQ(object.as<Json::objecttype>().size(), 42);
+
+    Json array(ArrayType{});
+    array.emplace_back(true);
+    array.append(array[0]);
+    auto &last = array.append(Json(Null{}));
+    EXPECT_EQ(&last, &array[2]);
+    EXPECT_EQ(array.dump(0), "[true,true,null]");
+    EXPECT_THROW(array.emplace("a"), std::logic_error);
+    EXPECT_THROW(object.emplace_back(), std::logic_error);
+    EXPECT_THROW(array.find("a"), std::logic_error);
+}
+TEST(JsonTest, flat_objects) {
+    std::string doc = "[";
+    for (int i = 0; i < 3; ++i) {
+        doc += "{";
+        for (int k = 40; k > 0; --k) {
+            doc += "\"k" + std::to_string(k) + "\":" + std::to_string(i * k);
+            doc += k > 1 ? "," : "},";
+        }
+    }
+    doc.back() = ']';
+    auto json = inline_parse(doc);
+    const auto &first = json[0].as<Json::objecttype>();
+    const auto &second = json[1].as<Json::objecttype>();
+    // insertion order, keys shared by the whole document
+    EXPECT_EQ(first.begin()->key, "k40");
+    EXPECT_EQ(first.key_pool(), second.key_pool());
+    EXPECT_EQ(first.key_pool()->size(), 40);
+    EXPECT_EQ(first.begin()->key.data(), second.begin()->key.data());
+    EXPECT_EQ(json[2]["k7"], Json(int64_t{14}));
+    EXPECT_FALSE(json[2].contains("k41"));
+    EXPECT_THROW(std::as_const(json)[2]["k41"], std::out_of_range);
+
+    Json copy = json[2];
+    copy["k41"] = Json(true);
+    EXPECT_EQ(copy["k41"], Json(true));
+    EXPECT_FALSE(json[2].contains("k41"));
+    EXPECT_EQ(copy.as<Json::objecttype>().size(), 41);
+
+    Json small(ObjectType{});
+    small["b"] = Json(1.5);
+    small["a"] = Json(Null{});
+    EXPECT_EQ(small.dump(0), R"({"b":1.5,"a":null})");
+    EXPECT_EQ(small, inline_parse(R"({"a":null,"b":1.5})"));
+    EXPECT_NE(small, inline_parse(R"({"a":null,"c":1.5})"));
+    small = std::move(json[1]);
+    EXPECT_EQ(small["k40"], Json(int64_t{40}));
+}
+TEST(JsonTest, copies_own_their_keys) {
+    auto json = inline_parse(R"({"a": {"b": 1}, "c": [{"b": 2}]})");
+    Json first = json;
+    Json second = json;
+    const auto *source_pool = json.as<Json::objecttype>().key_pool();
+    const auto *pool = first.as<Json::objecttype>().key_pool();
+    EXPECT_NE(pool, source_pool);
+    EXPECT_NE(pool, second.as<Json::objecttype>().key_pool());
+    // one pool per copy, not per object
+    EXPECT_EQ(first["a"].as<Json::objecttype>().key_pool(), pool);
+    EXPECT_EQ(first["c"][0].as<Json::objecttype>().key_pool(), pool);
+
+    // new keys go to each copy's own pool, so the copies can grow on two
+    // threads at once
+    auto grow = [](Json &copy, const std::string &prefix) {
+        for (int i = 0; i < 1000; ++i) {
+            copy[prefix + std::to_string(i)] = Json(i);
+            copy["a"][prefix + std::to_string(i)] = Json(i);
+        }
+    };
+    std::thread thread([&]() { grow(first, "x"); });
+    grow(second, "y");
+    thread.join();
+    EXPECT_EQ(first.as<Json::objecttype>().size(), 1002);
+    EXPECT_EQ(second["a"]["y999"], Json(999));
+    EXPECT_FALSE(first.contains("y0"));
+    EXPECT_FALSE(second["a"].contains("x0"));
+    EXPECT_EQ(json.dump(0), R"({"a":{"b":1},"c":[{"b":2}]})");
+    EXPECT_EQ(json.as<Json::objecttype>().key_pool()->size(), 3);
+}
+TEST(JsonTest, duplicate_keys) {
+    std::string doc = "{";
+    for (int k = 0; k < 40; ++k) {
+        doc += "\"k" + std::to_string(k) + "\":1,";
+    }
+    for (std::string dup : {R"("k3":1})", R"("k29":1})", R"("new":1})"}) {
+        bool rejected = false;
+        try {
+            inline_parse(doc + dup);
+        } catch (const std::runtime_error &) {
+            rejected = true;
+        }
+        EXPECT_EQ(rejected, dup != R"("new":1})") << dup;
+    }
+    EXPECT_THROW(inline_parse(R"({"a":1,"a":2})"), std::runtime_error);
+}
+// NOLINTEND
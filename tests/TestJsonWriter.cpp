@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include "JsonWriter.hpp"
+#include "Reader.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+void write_document(JsonWriter &writer) {
+    writer.begin_object();
+    writer.key("id").value(12).key("big").value(UINT64_MAX);
+    writer.key("pi").value(-1.5e3).key("ok").value(true).key("none").null();
+    writer.key("esc\n").value("a\"b\\\x01\t\xC3\xA9");
+    writer.key("empty").begin_object();
+    writer.key("a").begin_array().end_array();
+    writer.key("o").begin_object().end_object();
+    writer.end_object();
+    writer.key("items").begin_array();
+    writer.begin_array().value(RawNumber{"1.50"}).begin_array().end_array();
+    writer.end_array();
+    writer.value(std::string("last")).end_array();
+    writer.end_object();
+}
+const char *expected = R"({
+  "id": 12, "big": 18446744073709551615, "pi": -1500, "ok": true,
+  "none": null, "esc\n": "a\"b\\\u0001\té",
+  "empty": {"a": [], "o": {}},
+  "items": [[1.50, []], "last"]
+})";
+} // namespace
+
+// NOLINTBEGIN
+TEST(JsonWriterTest, same_as_dump) {
+    auto json = inline_parse(expected, std::pmr::get_default_resource(),
+                             {.raw_numbers = true});
+    for (int size : {0, 2, 4}) {
+        std::string out;
+        JsonWriter writer(out, size);
+        write_document(writer);
+        EXPECT_TRUE(writer.complete());
+        writer.finish();
+        EXPECT_EQ(out, json.dump(size)) << size;
+    }
+    std::string scalar;
+    JsonWriter(scalar).value("s").finish();
+    EXPECT_EQ(scalar, R"("s")");
+}
+TEST(JsonWriterTest, control_characters) {
+    std::string out;
+    std::string run(40, 'x');
+    JsonWriter(out, 0)
+        .begin_array()
+        .value("a\x1F" "b")
+        .value(run + "\x1A")
+        .end_array()
+        .finish();
+    EXPECT_EQ(out, R"(["a\u001Fb",")" + run + R"(\u001A"])");
+    EXPECT_EQ(inline_parse(out)[1].as<std::string>(), run + "\x1A");
+}
+TEST(JsonWriterTest, nesting_errors) {
+    std::string out;
+    EXPECT_THROW(JsonWriter(out).key("a"), std::logic_error);
+    EXPECT_THROW(JsonWriter(out).end_array(), std::logic_error);
+    EXPECT_THROW(JsonWriter(out).begin_array().end_object(), std::logic_error);
+    EXPECT_THROW(JsonWriter(out).begin_object().value(1), std::logic_error);
+    EXPECT_THROW(JsonWriter(out).begin_object().key("a").key("b"),
+                 std::logic_error);
+    EXPECT_THROW(JsonWriter(out).begin_object().key("a").end_object(),
+                 std::logic_error);
+    EXPECT_THROW(JsonWriter(out).begin_array().key("a"), std::logic_error);
+    EXPECT_THROW(JsonWriter(out).null().null(), std::logic_error);
+    EXPECT_THROW(JsonWriter(out).begin_array().finish(), std::logic_error);
+    EXPECT_THROW(JsonWriter(out).finish(), std::logic_error);
+}
+TEST(JsonWriterTest, streams) {
+    // big enough to be flushed several times on the way
+    auto write = [](JsonWriter &writer) {
+        writer.begin_array();
+        for (int i = 0; i < 20000; ++i) {
+            writer.begin_object().key("id").value(i).key("name").value(
+                "record " + std::to_string(i));
+            writer.end_object();
+        }
+        writer.end_array().finish();
+    };
+    std::string expected;
+    JsonWriter in_memory(expected, 2);
+    write(in_memory);
+    EXPECT_GT(expected.size(), 4 * JsonWriter::flush_size);
+
+    std::ostringstream os;
+    JsonWriter to_stream(os, 2);
+    write(to_stream);
+    EXPECT_EQ(os.str(), expected);
+
+    auto path = testing::TempDir() + "json_writer_test.json";
+    auto *file = std::fopen(path.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    {
+        JsonWriter to_fd(fileno(file), 2);
+        write(to_fd);
+    }
+    std::fclose(file);
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    EXPECT_EQ(content.str(), expected);
+    std::remove(path.c_str());
+}
+// NOLINTEND
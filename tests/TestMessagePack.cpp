@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include "MessagePack.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+// NOLINTBEGIN
+TEST(MessagePackTest, round_trip) {
+    std::string text = R"({"null": null, "bool": [true, false], "ints": [0, 127,
+        128, 255, 256, 65535, 65536, 4294967295, 4294967296, -1, -32, -33,
+        -128, -129, -32768, -32769, -2147483648, -2147483649,
+        9223372036854775807, 9223372036854775808, 18446744073709551615,
+        -9223372036854775808], "doubles": [1.5, -0.25, 1e300, 1.0],
+        "strings": ["", "short", ")" +
+                       std::string(40, 'x') + R"(", ")" +
+                       std::string(300, 'y') + R"(", ")" +
+                       std::string(70000, 'z') + R"(", "esc\"aped\n"],
+        "nested": [[[]], {}, {"a": {"b": [1, {"c": null}]}}]})";
+    auto json = inline_parse(text);
+    auto encoded = to_msgpack(json);
+    EXPECT_EQ(from_msgpack(encoded), json);
+    EXPECT_EQ(from_msgpack(encoded).dump(), json.dump());
+    auto raw = inline_parse(text, std::pmr::get_default_resource(),
+                            {.raw_numbers = true});
+    EXPECT_EQ(to_msgpack(raw), encoded);
+
+    Json big(ArrayType{}, std::pmr::get_default_resource());
+    Json wide(ObjectType{}, std::pmr::get_default_resource());
+    for (int i = 0; i < 70000; ++i) {
+        big.append(Json(int64_t{i}));
+        wide["k" + std::to_string(i)] = Json(int64_t{i});
+    }
+    EXPECT_EQ(from_msgpack(to_msgpack(big)), big);
+    EXPECT_EQ(from_msgpack(to_msgpack(wide)), wide);
+
+    // exact encodings of a few values
+    EXPECT_EQ(to_msgpack(inline_parse("[1,-1,null]")), "\x93\x01\xFF\xC0");
+    EXPECT_EQ(to_msgpack(inline_parse(R"({"a":"b"})")), "\x81\xA1"
+                                                        "a\xA1"
+                                                        "b");
+}
+TEST(MessagePackTest, borrowed_strings) {
+    auto encoded = to_msgpack(inline_parse(R"(["view", {"k": "v"}])"));
+    auto json = from_msgpack(encoded, std::pmr::get_default_resource(),
+                             {.borrow_strings = true});
+    EXPECT_EQ(json[0].as<std::string_view>().data(), encoded.data() + 2);
+    EXPECT_EQ(json, inline_parse(R"(["view", {"k": "v"}])"));
+}
+TEST(MessagePackTest, errors) {
+    auto message = [](std::string_view data) {
+        try {
+            from_msgpack(data);
+        } catch (const std::runtime_error &ex) {
+            return std::string(ex.what());
+        }
+        return std::string();
+    };
+    using namespace std::string_view_literals;
+    EXPECT_EQ(message(""), "msgpack: unexpected end of input at offset 0");
+    EXPECT_EQ(message("\x92\x01"),
+              "msgpack: unexpected end of input at offset 1");
+    EXPECT_EQ(message("\xCD\x01"),
+              "msgpack: unexpected end of input at offset 1");
+    EXPECT_EQ(message("\x01\x02"), "msgpack: trailing bytes at offset 1");
+    EXPECT_EQ(message("\x81\x01\x02"),
+              "msgpack: map key is not a string at offset 1");
+    EXPECT_EQ(message("\x82\xA1k\x01\xA1k\x02"),
+              "msgpack: duplicate map key at offset 4");
+    EXPECT_EQ(message("\xC4\x00"sv), "msgpack: unsupported type at offset 0");
+    EXPECT_EQ(message("\xDD\xFF\xFF\xFF\xFF"),
+              "msgpack: unexpected end of input at offset 5");
+}
+TEST(MessagePackTest, load_file) {
+    auto json = inline_parse(R"({"k": ["view", 1.5, -7]})");
+    auto path = testing::TempDir() + "cache.msgpack";
+    std::ofstream(path, std::ios::binary) << to_msgpack(json);
+    auto document = load_msgpack_file(path);
+    ASSERT_TRUE(document.source->mapped());
+    EXPECT_EQ(document.root, json);
+    EXPECT_EQ(document.root["k"][0].as<std::string_view>().data(),
+              document.source->view().data() + 5);
+    const auto &array = document.root["k"].as<Json::arraytype>();
+    EXPECT_EQ(array.get_allocator().resource(), document.arena.get());
+    std::remove(path.c_str());
+}
+// NOLINTEND
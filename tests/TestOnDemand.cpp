@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include "OnDemand.hpp"
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string doc = R"( {
+  "skip": {"a": "}]\"{[", "b": [[], {"c": "\\"}], "n": -1.5e3},
+  "data": {"items": [
+    {"id": 10, "tags": ["x"]},
+    {"id": 11, "tags": []},
+    {"id": 12, "a/b": {"m~n": true}, "esc\u0041ped": "yes"}
+  ]},
+  "": 0
+})";
+}
+
+// NOLINTBEGIN
+TEST(OnDemandTest, pointers_match_full_parse) {
+    auto full = inline_parse(doc);
+    EXPECT_EQ(*parse_pointer(doc, ""), full);
+    EXPECT_EQ(*parse_pointer(doc, "/data/items/2/id"), Json(int64_t{12}));
+    EXPECT_EQ(*parse_pointer(doc, "/data/items/0/tags"),
+              full["data"]["items"][0]["tags"]);
+    EXPECT_EQ(*parse_pointer(doc, "/skip"), full["skip"]);
+    EXPECT_EQ(*parse_pointer(doc, "/data/items/2/a~1b/m~0n"), Json(true));
+    EXPECT_EQ(*parse_pointer(doc, "/data/items/2/escAped"),
+              Json(std::string("yes")));
+    EXPECT_EQ(*parse_pointer(doc, "/"), Json(int64_t{0}));
+    for (const char *missing : {"/nope", "/data/items/3", "/data/items/-",
+                                "/data/items/01", "/data/items/x",
+                                "/data/items/0/id/deeper", "/skip/n/0"}) {
+        EXPECT_FALSE(parse_pointer(doc, missing)) << missing;
+    }
+    EXPECT_THROW(parse_pointer(doc, "data"), std::invalid_argument);
+}
+TEST(OnDemandTest, lazy_values) {
+    LazyValue root(doc);
+    EXPECT_EQ(root.get_type(), Json::Type::OBJECT);
+    auto items = root["data"]["items"];
+    EXPECT_EQ(items.get_type(), Json::Type::ARRAY);
+    EXPECT_EQ(items[1].raw(), R"({"id": 11, "tags": []})");
+    EXPECT_EQ(items[1]["id"].parse(), Json(int64_t{11}));
+    EXPECT_EQ(root["skip"]["n"].raw(), "-1.5e3");
+    EXPECT_THROW(items[3], std::out_of_range);
+    EXPECT_THROW(items["id"], std::logic_error);
+    EXPECT_THROW(root[0], std::logic_error);
+    EXPECT_THROW(LazyValue(R"({"a": [1, 2)")["b"], std::runtime_error);
+}
+TEST(OnDemandTest, iterators) {
+    static_assert(std::forward_iterator<LazyIterator<LazyValue>>);
+    static_assert(std::forward_iterator<LazyIterator<LazyMember>>);
+    // indexing each element would skip ~n^2/2 of them
+    std::string big = "[";
+    for (int i = 0; i < 200000; ++i) {
+        big += R"({"id": )" + std::to_string(i) + R"(, "s": "]}"},)";
+    }
+    big.back() = ']';
+    int64_t expected = 0;
+    for (auto element : LazyValue(big).elements()) {
+        ASSERT_EQ(element["id"].parse(), Json(expected)) << expected;
+        ++expected;
+    }
+    EXPECT_EQ(expected, 200000);
+
+    auto items = LazyValue(doc)["data"]["items"].elements();
+    auto it = items.begin();
+    auto copy = it++;
+    EXPECT_EQ((*copy)["id"].raw(), "10");
+    EXPECT_EQ((*it)["id"].raw(), "11");
+    EXPECT_EQ(std::distance(it, items.end()), 2);
+    EXPECT_EQ(std::distance(items.begin(), items.end()), 3);
+
+    std::vector<std::string> keys;
+    for (auto member : LazyValue(doc)["data"]["items"][2].members()) {
+        keys.push_back(member.key());
+    }
+    EXPECT_EQ(keys, (std::vector<std::string>{"id", "a/b", "escAped"}));
+    auto skip = LazyValue(doc)["skip"].members().begin();
+    EXPECT_EQ((*++skip).raw_key, "b");
+    EXPECT_EQ((*skip).value.raw(), R"([[], {"c": "\\"}])");
+
+    EXPECT_EQ(LazyValue("[]").elements().begin(),
+              LazyValue("[]").elements().end());
+    EXPECT_EQ(LazyValue(" { } ").members().begin(),
+              LazyValue(" { } ").members().end());
+    EXPECT_THROW(LazyValue("{}").elements(), std::logic_error);
+    EXPECT_THROW(LazyValue("[1]").members(), std::logic_error);
+    auto broken = LazyValue("[1 2]").elements().begin();
+    EXPECT_THROW(++broken, std::runtime_error);
+}
+TEST(OnDemandTest, missing_values) {
+    auto walk = [](const LazyValue &value) {
+        size_t count = 0;
+        if (value.get_type() == Json::Type::ARRAY) {
+            for (auto element : value.elements()) {
+                (void)element;
+                ++count;
+            }
+        } else {
+            for (auto member : value.members()) {
+                (void)member;
+                ++count;
+            }
+        }
+        return count;
+    };
+    EXPECT_THROW(walk(LazyValue("[1,]")), std::runtime_error);
+    EXPECT_THROW(walk(LazyValue("[,]")), std::runtime_error);
+    EXPECT_THROW(walk(LazyValue(R"({"a":1,})")), std::runtime_error);
+    EXPECT_THROW(walk(LazyValue(R"({"a":})")), std::runtime_error);
+    EXPECT_THROW(LazyValue("[1,]").find(1), std::runtime_error);
+    EXPECT_THROW(LazyValue("[,]").find(0), std::runtime_error);
+    EXPECT_THROW(LazyValue(R"({"a":1,})").find("b"), std::runtime_error);
+    EXPECT_THROW(LazyValue("[1,]").find_pointer("/1"), std::runtime_error);
+    EXPECT_THROW(LazyValue("[,]").find_pointer("/0"), std::runtime_error);
+    EXPECT_THROW(LazyValue(R"({"a":1,})").find_pointer("/b"),
+                 std::runtime_error);
+    EXPECT_EQ(LazyValue("-1").get_type(), Json::Type::NUMBER);
+    EXPECT_EQ(LazyValue(" 0").get_type(), Json::Type::NUMBER);
+    for (const char *bad : {"]", ",", "}", "x", "+1", ".5"}) {
+        EXPECT_THROW(LazyValue(bad).get_type(), std::runtime_error) << bad;
+    }
+    EXPECT_THROW(LazyValue(R"({"a": x})")["a"].get_type(),
+                 std::runtime_error);
+    EXPECT_THROW(LazyValue(R"({"a": ?})").find_pointer("/a/0"),
+                 std::runtime_error);
+    // items before the bad one are still reached
+    EXPECT_EQ(LazyValue("[1,]").find(0)->raw(), "1");
+    EXPECT_EQ(walk(LazyValue(R"([1, [2], {"a": 3}])")), 3);
+}
+// NOLINTEND
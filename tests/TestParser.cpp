@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+
+#include "Reader.hpp"
+#include "WorkerPool.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+// NOLINTBEGIN
+TEST(ParserTest, inline_and_threaded_agree) {
+    std::string doc = "[";
+    for (int i = 0; i < 5000; ++i) {
+        doc += R"({"id":)" + std::to_string(i) + R"(,"tags":["a",null,true]},)";
+    }
+    doc += "{}]";
+    auto expected = inline_parse(doc);
+    EXPECT_EQ(threaded_parse(doc, 0), expected);
+    EXPECT_EQ(threaded_parse(doc), expected);
+    EXPECT_EQ(expected[5000], Json(ObjectType{}));
+}
+TEST(ParserTest, errors) {
+    for (auto doc : {R"([1,2)", R"({"a":1,})", R"([]])", R"(tru)",
+                     R"({"a":1,"a":2})"}) {
+        EXPECT_ANY_THROW({ inline_parse(doc); });
+        EXPECT_ANY_THROW({ threaded_parse(doc, 0); });
+    }
+}
+TEST(ParserTest, error_after_full_channel) {
+    std::string doc = "[";
+    for (int i = 0; i < 10000; ++i) {
+        doc += "1,";
+    }
+    for (const auto &bad : {doc + "1 2]", doc + "x]"}) {
+        std::string expected;
+        try {
+            inline_parse(bad);
+        } catch (const std::runtime_error &ex) {
+            expected = ex.what();
+        }
+        EXPECT_FALSE(expected.empty());
+        try {
+            threaded_parse(bad, 0);
+            ADD_FAILURE();
+        } catch (const std::runtime_error &ex) {
+            EXPECT_EQ(ex.what(), expected);
+        }
+    }
+}
+TEST(ParserTest, grammar_error_before_lexer_error) {
+    // the lexer fails at `@` while the parser is still far behind; the
+    // tokens before it must reach the parser, whose error comes first
+    std::string doc = "[";
+    for (int i = 0; i < 40000; ++i) {
+        doc += "1,";
+    }
+    doc += "1 2 @]";
+    std::string expected;
+    try {
+        inline_parse(doc);
+    } catch (const std::runtime_error &ex) {
+        expected = ex.what();
+    }
+    EXPECT_NE(expected.find("Expected comma or closing bracket"),
+              std::string::npos);
+    for (int i = 0; i < 12; ++i) {
+        try {
+            threaded_parse(doc, 0);
+            ADD_FAILURE();
+        } catch (const std::runtime_error &ex) {
+            EXPECT_EQ(ex.what(), expected);
+        }
+    }
+}
+TEST(ParserTest, try_parse) {
+    auto ok = try_parse(R"({"a":[1,"x"]})");
+    ASSERT_TRUE(ok);
+    EXPECT_EQ((*ok)["a"][1].as<std::string_view>(), "x");
+
+    using Kind = ParseError::Kind;
+    struct Case {
+        const char *doc;
+        Kind kind;
+        size_t offset;
+        int line;
+        int column;
+    };
+    for (auto [doc, kind, offset, line, column] : {
+             Case{"[1,2", Kind::COMMA_OR_BRACKET_EXPECTED, 4, 1, 3},
+             Case{R"({"a":1,})", Kind::PROPERTY_EXPECTED, 8, 1, 8},
+             Case{"[]]", Kind::END_OF_FILE_EXPECTED, 3, 1, 4},
+             Case{"tru", Kind::VALUE_EXPECTED, 1, 1, 2},
+             Case{R"({"a":1,"a":2})", Kind::DUPLICATE_KEY, 10, 1, 10},
+             Case{"[1,\n  \"a\\x\"]", Kind::INVALID_ESCAPE, 9, 2, 6},
+             Case{"[1e999]", Kind::NUMBER_OUT_OF_RANGE, 1, 1, 2},
+             Case{"", Kind::VALUE_EXPECTED, 0, 1, 1},
+         }) {
+        auto result = try_parse(doc);
+        ASSERT_FALSE(result.has_value()) << doc;
+        const auto &error = result.error();
+        EXPECT_EQ(error.kind, kind) << doc;
+        EXPECT_EQ(error.offset, offset) << doc;
+        EXPECT_EQ(error.line, line) << doc;
+        EXPECT_EQ(error.column, column) << doc;
+        // threaded_parse still throws from the lexer and the SaxParser
+        try {
+            threaded_parse(doc, 0);
+            ADD_FAILURE() << doc;
+        } catch (const std::runtime_error &ex) {
+            EXPECT_EQ(ex.what(), error.message());
+        }
+        EXPECT_THROW(std::move(result).value(), std::runtime_error);
+    }
+}
+TEST(ParserTest, document_arena) {
+    auto document = parse_document(R"([[1,2,3],{"a":[true]},"s"])", 0);
+    const auto &root = document.root;
+    EXPECT_EQ(root.as<Json::arraytype>().get_allocator().resource(),
+              document.arena.get());
+    const auto &inner = root[0].as<Json::arraytype>();
+    EXPECT_EQ(inner.get_allocator().resource(), document.arena.get());
+    EXPECT_EQ(inner.size(), 3);
+    EXPECT_EQ(root[1]["a"].as<Json::arraytype>().get_allocator().resource(),
+              document.arena.get());
+    EXPECT_EQ(root, inline_parse(R"([[1,2,3],{"a":[true]},"s"])"));
+}
+TEST(ParserTest, borrowed_strings) {
+    std::string input = R"({"k":["view","esc\"aped"]})";
+    auto json =
+        inline_parse(input, std::pmr::get_default_resource(),
+                     ParseOptions{.borrow_strings = true});
+    const auto &view = json["k"][0];
+    EXPECT_EQ(view.get_type(), Json::Type::STRING);
+    EXPECT_TRUE(view.is<std::string_view>());
+    EXPECT_EQ(view.as<std::string_view>().data(), input.data() + 7);
+    EXPECT_EQ(json["k"][1].as<std::string>(), "esc\"aped");
+    EXPECT_EQ(json, inline_parse(input));
+}
+TEST(ParserTest, raw_numbers) {
+    ParseOptions raw{.raw_numbers = true};
+    std::string input =
+        "[1E2,0.50,-0,0,1e300,12345678901234567890123,-12,0e1,1.5e+07]";
+    auto json = inline_parse(input, std::pmr::get_default_resource(), raw);
+    EXPECT_EQ(json.dump(0), input);
+    EXPECT_TRUE(json[0].is<RawNumber>());
+    EXPECT_EQ(json[0].get_type(), Json::Type::NUMBER);
+    EXPECT_DOUBLE_EQ(json[0].as<double>(), 100);
+    EXPECT_EQ(json[6].as<int64_t>(), -12);
+    EXPECT_THROW(json[1].as<int64_t>(), std::logic_error);
+    EXPECT_EQ(json, inline_parse(input));
+    for (std::string doc : {"[1.]", "[-]", "[0E5]", "[00.5]", "[1.5e]",
+                            "[1e400]", "[-01]", "[1e+]"}) {
+        std::string expected, actual;
+        try {
+            inline_parse(doc);
+        } catch (const std::runtime_error &ex) {
+            expected = ex.what();
+        }
+        try {
+            inline_parse(doc, std::pmr::get_default_resource(), raw);
+        } catch (const std::runtime_error &ex) {
+            actual = ex.what();
+        }
+        EXPECT_FALSE(expected.empty()) << doc;
+        EXPECT_EQ(actual, expected) << doc;
+    }
+}
+TEST(ParserTest, mapped_file) {
+    std::string input = R"({"k":["view",1.5]})";
+    auto path = testing::TempDir() + "mapped_file.json";
+    std::ofstream(path) << input;
+    auto document =
+        parse_file(path, inline_parse_threshold, {.borrow_strings = true});
+    ASSERT_TRUE(document.source->mapped());
+    EXPECT_EQ(document.source->view(), input);
+    EXPECT_EQ(document.root["k"][0].as<std::string_view>().data(),
+              document.source->view().data() + 7);
+    EXPECT_EQ(document.root, inline_parse(input));
+    std::remove(path.c_str());
+    EXPECT_THROW(parse_file(path), std::runtime_error);
+}
+TEST(ParserTest, parallel_parse) {
+    // strings full of structural characters and escapes, so that chunk
+    // boundaries land inside them
+    std::string doc = " [";
+    for (int i = 0; i < 6000; ++i) {
+        doc += R"({"s":"],[{,\"\\)" + std::string(2 * (i % 7), '\\') +
+               R"(","n":[)" + std::to_string(i) + R"(,[[]],"\"]"]},)";
+    }
+    doc += "[], \"tail\" ]\n";
+    auto expected = inline_parse(doc);
+    for (size_t threads : {0, 1, 3}) {
+        WorkerPool pool(threads);
+        EXPECT_EQ(parallel_parse(doc, pool), expected) << threads;
+        EXPECT_EQ(parallel_parse(std::string(2 * doc.size(), ' ') + "[ ]",
+                                 pool),
+                  inline_parse("[]"));
+        for (const auto &bad :
+             {doc + "]", doc.substr(0, doc.size() - 3) + "}",
+              doc.substr(0, doc.size() - 3) + ",]", "{" + doc + "}",
+              doc.substr(0, doc.size() / 2), doc + "1"}) {
+            std::string message;
+            try {
+                inline_parse(bad);
+            } catch (const std::runtime_error &ex) {
+                message = ex.what();
+            }
+            EXPECT_FALSE(message.empty());
+            try {
+                parallel_parse(bad, pool);
+                ADD_FAILURE();
+            } catch (const std::runtime_error &ex) {
+                EXPECT_EQ(ex.what(), message);
+            }
+        }
+    }
+    EXPECT_EQ(parallel_parse(R"({"a":[1]})"), inline_parse(R"({"a":[1]})"));
+}
+// NOLINTEND
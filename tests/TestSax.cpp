@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "Sax.hpp"
+#include <string>
+
+namespace {
+struct Recorder : SaxHandler {
+    std::string events;
+    void null() override { events += "null "; }
+    void boolean(bool value) override {
+        events += value ? "true " : "false ";
+    }
+    void number(double value) override {
+        events += std::to_string(static_cast<int>(value)) + " ";
+    }
+    void string(std::string_view value) override {
+        events += "s:" + std::string(value) + " ";
+    }
+    void start_array() override { events += "[ "; }
+    void end_array() override { events += "] "; }
+    void start_object() override { events += "{ "; }
+    bool key(std::string_view value) override {
+        events += "k:" + std::string(value) + " ";
+        return true;
+    }
+    void end_object() override { events += "} "; }
+};
+std::string record(std::string_view doc) {
+    Lexer lexer(doc);
+    Parser parser(lexer);
+    Recorder recorder;
+    parser.parse(recorder);
+    return recorder.events;
+}
+} // namespace
+
+// NOLINTBEGIN
+TEST(SaxTest, events) {
+    EXPECT_EQ(record(R"({"a":[1,true,null],"b":{},"c":"x\ny"})"),
+              "{ k:a [ 1 true null ] k:b { } k:c s:x\ny } ");
+    EXPECT_EQ(record("[[],[[]]]"), "[ [ ] [ [ ] ] ] ");
+    EXPECT_EQ(record("7"), "7 ");
+}
+TEST(SaxTest, errors) {
+    // duplicate keys are only rejected by handlers that say so
+    EXPECT_EQ(record(R"({"a":1,"a":2})"), "{ k:a 1 k:a 2 } ");
+    for (auto doc : {"", "[", "{", "[1 2]", "[,]", "[1,]", R"({"a" 1})",
+                     R"({"a":})", "{,}", "[]]", "[}"}) {
+        EXPECT_ANY_THROW({ record(doc); }) << doc;
+    }
+}
+TEST(SaxTest, dom_builder) {
+    Lexer lexer(R"({"k":[1,"two",{"three":[3]}]})");
+    Parser parser(lexer);
+    DomBuilder builder;
+    parser.parse(builder);
+    const auto &json = builder.result();
+    EXPECT_EQ(json["k"][1], Json(std::string("two")));
+    EXPECT_EQ(json["k"][2]["three"][0], Json(3.0));
+    try {
+        inline_parse(R"({"a":1,"a":2})");
+        FAIL();
+    } catch (const std::runtime_error &ex) {
+        EXPECT_STREQ(ex.what(), "1:10: Duplicate object key");
+    }
+}
+// NOLINTEND
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include "Reader.hpp"
+#include "Scan.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// Lexes `input` to the end and records every token position, or the error.
+std::string positions(const std::string &input) {
+    Lexer lexer(input);
+    std::string out;
+    try {
+        while (true) {
+            auto token = lexer.get_next_token();
+            out += std::to_string(token.lineno) + ":" +
+                   std::to_string(token.col_offset) + " " + token.get_type() +
+                   " ";
+            if (token.type == Token::Type::EOF_) {
+                return out;
+            }
+        }
+    } catch (const std::runtime_error &ex) {
+        return out + "ERR " + ex.what();
+    }
+}
+} // namespace
+
+// NOLINTBEGIN
+TEST(ScanTest, implementations_agree) {
+    std::mt19937 rng(42);
+    const char alphabet[] = "ab\"\\\x01\x19\x1a\x7f\x80\xff";
+    for (int round = 0; round < 2000; ++round) {
+        std::string s(rng() % 100, 'x');
+        for (auto k = rng() % 3; k > 0 && !s.empty(); --k) {
+            s[rng() % s.size()] = alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+        const char *begin = s.data();
+        const char *end = s.data() + s.size();
+        auto *expected = find_string_special_scalar(begin, end);
+        EXPECT_EQ(find_string_special(begin, end), expected);
+#if defined(__x86_64__) || defined(__i386__)
+        EXPECT_EQ(find_string_special_sse2(begin, end), expected);
+        if (__builtin_cpu_supports("avx2")) {
+            EXPECT_EQ(find_string_special_avx2(begin, end), expected);
+        }
+#endif
+    }
+}
+TEST(ScanTest, container_implementations_agree) {
+    std::mt19937 rng(7);
+    const char alphabet[] = "\"[]{}{;[=]}\\\x7b\xfb\xdb";
+    for (int round = 0; round < 2000; ++round) {
+        std::string s(rng() % 100, 'x');
+        for (auto k = rng() % 3; k > 0 && !s.empty(); --k) {
+            s[rng() % s.size()] = alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+        const char *begin = s.data();
+        const char *end = s.data() + s.size();
+        auto *expected = find_container_special_scalar(begin, end);
+        EXPECT_EQ(find_container_special(begin, end), expected);
+#if defined(__x86_64__) || defined(__i386__)
+        EXPECT_EQ(find_container_special_sse2(begin, end), expected);
+        if (__builtin_cpu_supports("avx2")) {
+            EXPECT_EQ(find_container_special_avx2(begin, end), expected);
+        }
+#endif
+    }
+}
+
+// Expected values were recorded with the byte-at-a-time lexer.
+TEST(ScanTest, errors_and_positions_unchanged) {
+    std::string pad32(33, 'a'), pad16(17, 'b');
+    EXPECT_EQ(positions("\"" + pad32), "ERR 1:35: Unexpected end of string.");
+    EXPECT_EQ(positions("\"" + pad32 + "\\"),
+              "ERR 1:36: Unexpected character after `\\`.");
+    EXPECT_EQ(positions("\"" + pad32 + "\x01\""),
+              "ERR 1:35: Unexpected character after `\\`.");
+    EXPECT_EQ(positions("\"" + pad16 + "\x19" + pad32 + "\""),
+              "ERR 1:19: Unexpected character after `\\`.");
+    EXPECT_EQ(positions("\"" + pad16 + "\x1a" + pad32 + "\""),
+              "1:54 STRING 1:54 EOF ");
+    EXPECT_EQ(positions("\"" + pad32 + "\\q" + pad16 + "\""),
+              "ERR 1:36: Invalid escape character in string.");
+    EXPECT_EQ(positions("\"" + pad32 + "\\n" + pad32 + "\x02\""),
+              "ERR 1:70: Unexpected character after `\\`.");
+    EXPECT_EQ(positions("\"" + pad32 + "\\u12G4\""),
+              "ERR 1:37: Invalid unicode sequence in string.");
+    EXPECT_EQ(positions("\"\xc3\xa9" + pad32 + "\\uD83Exx\""),
+              "ERR 1:43: Invalid unicode sequence in string.");
+    EXPECT_EQ(positions("[\n  \"" + pad32 + "\",\n  \"\xe2\x82\xac" + pad16 +
+                        "\",\n \"" + pad16 + "\x05\"]"),
+              "1:2 BEGIN_ARRAY 2:38 STRING 2:39 VALUE_SEPARATOR 3:25 STRING "
+              "3:26 VALUE_SEPARATOR ERR 4:20: Unexpected character after "
+              "`\\`.");
+}
+// NOLINTEND
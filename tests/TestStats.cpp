@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include "Reader.hpp"
+#include <string>
+
+// NOLINTBEGIN
+TEST(StatsTest, parse_stats) {
+    std::string doc = R"([{"a":[1,2.5,"a long string that is not \"inline\""]},)";
+    doc += std::string(100000, ' ') + "null]";
+    for (size_t threshold : {SIZE_MAX, size_t{0}}) {
+        ParseStats stats;
+        auto json = threaded_parse(doc, threshold,
+                                   std::pmr::get_default_resource(),
+                                   {.stats = &stats});
+        EXPECT_EQ(json, inline_parse(doc));
+        if constexpr (!stats_enabled) {
+            EXPECT_EQ(stats.to_json(), ParseStats().to_json());
+            continue;
+        }
+        EXPECT_EQ(stats.bytes_lexed, doc.size());
+        auto tokens = [&](Token::Type type) {
+            return stats.tokens[static_cast<size_t>(type)];
+        };
+        EXPECT_EQ(tokens(Token::Type::BEGIN_ARRAY), 2);
+        EXPECT_EQ(tokens(Token::Type::NUMBER), 2);
+        EXPECT_EQ(tokens(Token::Type::STRING), 2);
+        EXPECT_EQ(tokens(Token::Type::VALUE_SEPARATOR), 3);
+        EXPECT_EQ(tokens(Token::Type::EOF_), 1);
+        EXPECT_EQ(stats.nodes, 7);
+        EXPECT_EQ(stats.max_depth, 3);
+        EXPECT_GE(stats.bytes_allocated, 5 * sizeof(Json) + 35);
+        EXPECT_GT(stats.lex_ns, 0);
+        EXPECT_GE(stats.total_ns, stats.parse_ns);
+        if (threshold == SIZE_MAX) {
+            EXPECT_GE(stats.parse_ns, stats.lex_ns);
+            EXPECT_EQ(stats.parser_wait_ns, 0);
+        }
+        EXPECT_EQ(stats.to_json()["tokens"]["NULL"], Json(uint64_t{1}));
+    }
+}
+// NOLINTEND
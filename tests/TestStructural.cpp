@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include "Reader.hpp"
+#include "Structural.hpp"
+#include <random>
+#include <string>
+
+namespace {
+// Either the dump of the parsed document or the error message.
+std::string outcome(Json (*parse)(std::string_view, std::pmr::memory_resource *,
+                                  ParseOptions),
+                    const std::string &doc) {
+    try {
+        return parse(doc, std::pmr::get_default_resource(), {}).dump(0);
+    } catch (const std::runtime_error &ex) {
+        return std::string("ERR ") + ex.what();
+    }
+}
+} // namespace
+
+// NOLINTBEGIN
+TEST(StructuralTest, index) {
+    std::string doc = R"( {"a\"b":[1, -2.5e3,true],"c" : null,"d\\":"x"} )";
+    StructuralIndex expected = {1,  2,  8,  9,  10, 11, 13, 19, 20, 24,
+                                25, 26, 30, 32, 36, 37, 42, 43, 46};
+    EXPECT_EQ(build_structural_index_scalar(doc), expected);
+    EXPECT_EQ(build_structural_index(doc), expected);
+}
+TEST(StructuralTest, simd_matches_scalar) {
+    std::mt19937 rng(7);
+    const char alphabet[] = "{}[]:, \n\t\"\\\\ab1-.e";
+    for (int round = 0; round < 500; ++round) {
+        std::string doc(rng() % 300, ' ');
+        for (auto &ch : doc) {
+            ch = alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+        EXPECT_EQ(build_structural_index(doc),
+                  build_structural_index_scalar(doc));
+    }
+}
+TEST(StructuralTest, same_result_as_inline_parse) {
+    std::string valid = R"({"id": 12, "name": "a \"quoted\" \\ name",)"
+                        R"( "tags": ["x", "yé", []], "ok": false,)"
+                        R"( "n": null, "v": [-0, 0.5, 1e10, {"k": true}]})";
+    EXPECT_EQ(outcome(indexed_parse, valid), outcome(inline_parse, valid));
+    std::mt19937 rng(11);
+    const char alphabet[] = "{}[]:,\" \\x1-";
+    for (int round = 0; round < 2000; ++round) {
+        auto doc = valid;
+        for (auto k = rng() % 3 + 1; k > 0; --k) {
+            doc[rng() % doc.size()] = alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+        EXPECT_EQ(outcome(indexed_parse, doc), outcome(inline_parse, doc))
+            << doc;
+    }
+}
+// NOLINTEND
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include "Tape.hpp"
+#include <string>
+#include <vector>
+
+namespace {
+const std::string doc = R"({
+  "id": 12, "big": 18446744073709551615, "pi": -1.5e3,
+  "ok": true, "no": false, "none": null, "esc": "a\"bé\n",
+  "empty": {"a": [], "o": {}, "s": ""},
+  "items": [{"id": 1, "tags": ["x", "y"]}, [[1], [2, [3]]], "last"]
+})";
+} // namespace
+
+// NOLINTBEGIN
+TEST(TapeTest, dump_matches_json) {
+    auto json = inline_parse(doc);
+    auto tape = tape_parse(doc);
+    for (int size : {0, 2, 4}) {
+        EXPECT_EQ(tape.dump(size), json.dump(size));
+    }
+    for (const char *scalar : {"1", "\"s\"", "null", "[]", "{}", "2.5"}) {
+        EXPECT_EQ(tape_parse(scalar).dump(), inline_parse(scalar).dump());
+    }
+    EXPECT_EQ(tape.root()["items"].dump(0), json["items"].dump(0));
+}
+TEST(TapeTest, navigation) {
+    auto tape = tape_parse(doc);
+    auto root = tape.root();
+    EXPECT_EQ(root.get_type(), Json::Type::OBJECT);
+    EXPECT_EQ(root.size(), 9);
+    EXPECT_EQ(root["id"].as<int64_t>(), 12);
+    EXPECT_EQ(root["big"].as<uint64_t>(), UINT64_MAX);
+    EXPECT_THROW(root["big"].as<int64_t>(), std::logic_error);
+    EXPECT_EQ(root["pi"].as<double>(), -1500);
+    EXPECT_TRUE(root["ok"].as<bool>());
+    EXPECT_TRUE(root["none"].is_null());
+    EXPECT_EQ(root["esc"].as<std::string_view>(), "a\"b\xC3\xA9\n");
+    EXPECT_EQ(root["empty"]["s"].as<std::string_view>(), "");
+    EXPECT_EQ(root["empty"]["a"].size(), 0);
+
+    auto items = root["items"];
+    EXPECT_EQ(items.size(), 3);
+    EXPECT_EQ(items[0]["tags"][1].as<std::string_view>(), "y");
+    EXPECT_EQ(items[1][1][1][0].as<int64_t>(), 3);
+    EXPECT_EQ(items[2].as<std::string_view>(), "last");
+    EXPECT_FALSE(items.find(3));
+    EXPECT_FALSE(root.find("missing"));
+    EXPECT_THROW(items[3], std::out_of_range);
+    EXPECT_THROW(root["missing"], std::out_of_range);
+    EXPECT_THROW(items["id"], std::logic_error);
+    EXPECT_THROW(root[0], std::logic_error);
+    EXPECT_THROW(root["id"].as<std::string_view>(), std::logic_error);
+    EXPECT_THROW(root["id"].size(), std::logic_error);
+
+    std::vector<std::string_view> keys;
+    for (auto it = root.begin(); it != root.end(); ++it) {
+        keys.push_back(it.key());
+    }
+    EXPECT_EQ(keys.size(), 9);
+    EXPECT_EQ(keys.front(), "id");
+    EXPECT_EQ(keys.back(), "items");
+    int64_t sum = 0;
+    for (auto value : root["items"][1][1]) {
+        sum += value.get_type() == Json::Type::NUMBER ? value.as<int64_t>()
+                                                      : 10;
+    }
+    EXPECT_EQ(sum, 12);
+}
+TEST(TapeTest, large_containers) {
+    // keys past JsonObject::index_threshold are checked through a hash set
+    std::string array = "[";
+    std::string object = "{";
+    for (int i = 0; i < 100; ++i) {
+        array += (i ? "," : "") + std::to_string(i);
+        object += (i ? ",\"k" : "\"k") + std::to_string(i) + "\":" +
+                  std::to_string(i);
+    }
+    array += "]";
+    object += "}";
+    auto tape = tape_parse(array);
+    EXPECT_EQ(tape.root().size(), 100);
+    EXPECT_EQ(tape.root()[99].as<int64_t>(), 99);
+    auto objects = tape_parse(object);
+    EXPECT_EQ(objects.root()["k64"].as<int64_t>(), 64);
+    EXPECT_EQ(objects.dump(0), inline_parse(object).dump(0));
+
+    object.back() = ',';
+    EXPECT_THROW(tape_parse(object + R"("k70": 1})"), std::runtime_error);
+}
+TEST(TapeTest, errors_match_parser) {
+    for (const char *bad :
+         {R"({"a": 1, "a": 2})", "[1, 2", "{\"a\" 1}", "[1] 2", ""}) {
+        std::string expected;
+        try {
+            inline_parse(bad);
+        } catch (const std::runtime_error &error) {
+            expected = error.what();
+        }
+        try {
+            tape_parse(bad);
+            ADD_FAILURE() << bad;
+        } catch (const std::runtime_error &error) {
+            EXPECT_EQ(error.what(), expected) << bad;
+        }
+    }
+}
+// NOLINTEND
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
 #include "Reader.hpp"
+#include <cstdint>
+#include <limits>
 
 void check_token(const Token &token, Token::Type type,
                  const std::string &value = "") {
@@ -11,6 +13,10 @@ void check_token(const Token &token, Token::Type type, double value) {
     EXPECT_EQ(token.type, type);
     EXPECT_DOUBLE_EQ(std::get<double>(token.value), value);
 }
+void check_token(const Token &token, Token::Type type, int64_t value) {
+    EXPECT_EQ(token.type, type);
+    EXPECT_EQ(std::get<int64_t>(token.value), value);
+}
 // NOLINTBEGIN
 TEST(TokenTest, unicode) {
     Lexer lexer(R"("\uD83E\uDD70\u0024\u00A3\u0418\u0939\u20AC\uD55C")");
@@ -40,10 +46,21 @@ TEST(TokenTest, strings) {
     check_token(lexer.get_next_token(), Token::Type::STRING, "\ndead\\/");
     check_token(lexer.get_next_token(), Token::Type::EOF_);
 }
+TEST(TokenTest, borrowed_strings) {
+    std::string_view input = R"("plain" "esc\taped")";
+    Lexer lexer(input, ParseOptions{.borrow_strings = true});
+    auto plain = lexer.get_next_token();
+    ASSERT_TRUE(std::holds_alternative<std::string_view>(plain.value));
+    auto view = std::get<std::string_view>(plain.value);
+    EXPECT_EQ(view, "plain");
+    EXPECT_EQ(view.data(), input.data() + 1);
+    check_token(lexer.get_next_token(), Token::Type::STRING, "esc\taped");
+    check_token(lexer.get_next_token(), Token::Type::EOF_);
+}
 TEST(TokenTest, numbers) {
     {
         Lexer lexer(R"(010.23,-10.23e-1)");
-        check_token(lexer.get_next_token(), Token::Type::NUMBER, 0);
+        check_token(lexer.get_next_token(), Token::Type::NUMBER, int64_t{0});
         check_token(lexer.get_next_token(), Token::Type::NUMBER, 10.23);
         check_token(lexer.get_next_token(), Token::Type::VALUE_SEPARATOR);
         check_token(lexer.get_next_token(), Token::Type::NUMBER, -10.23e-1);
@@ -55,6 +72,30 @@ TEST(TokenTest, numbers) {
         check_token(lexer.get_next_token(), Token::Type::EOF_);
     }
 }
+TEST(TokenTest, integers) {
+    Lexer lexer("[42,-7,9223372036854775807,-9223372036854775808,"
+                "18446744073709551615,18446744073709551616,"
+                "-9223372036854775809,12e1,-0]");
+    EXPECT_EQ(lexer.get_next_token().type, Token::Type::BEGIN_ARRAY);
+    auto next_number = [&]() {
+        auto token = lexer.get_next_token();
+        EXPECT_EQ(token.type, Token::Type::NUMBER);
+        lexer.get_next_token(); // , or ]
+        return token;
+    };
+    check_token(next_number(), Token::Type::NUMBER, int64_t{42});
+    check_token(next_number(), Token::Type::NUMBER, int64_t{-7});
+    check_token(next_number(), Token::Type::NUMBER,
+                std::numeric_limits<int64_t>::max());
+    check_token(next_number(), Token::Type::NUMBER,
+                std::numeric_limits<int64_t>::min());
+    EXPECT_EQ(std::get<uint64_t>(next_number().value),
+              std::numeric_limits<uint64_t>::max());
+    check_token(next_number(), Token::Type::NUMBER, 18446744073709551616.0);
+    check_token(next_number(), Token::Type::NUMBER, -9223372036854775809.0);
+    check_token(next_number(), Token::Type::NUMBER, 120.0);
+    check_token(next_number(), Token::Type::NUMBER, -0.0);
+}
 TEST(TokenTest, exceptions) {
     {
         Lexer lexer(R"(")");
@@ -0,0 +1,24 @@
+#include <gtest/gtest.h>
+
+#include "WorkerPool.hpp"
+#include <atomic>
+#include <vector>
+
+// NOLINTBEGIN
+TEST(WorkerPoolTest, parallel_for_visits_each_index_once) {
+    for (size_t threads : {0, 1, 3, 7}) {
+        WorkerPool pool(threads);
+        for (size_t count : {0, 1, 5, 1000}) {
+            std::vector<std::atomic<int>> hits(count);
+            pool.parallel_for(count, [&](size_t i) { ++hits[i]; });
+            for (size_t i = 0; i < count; ++i) {
+                EXPECT_EQ(hits[i].load(), 1) << threads << " " << i;
+            }
+        }
+    }
+}
+TEST(WorkerPoolTest, try_run_needs_an_idle_worker) {
+    WorkerPool pool(0);
+    EXPECT_FALSE(pool.try_run([] {}));
+}
+// NOLINTEND
@@ -1,18 +1,35 @@
 add_rules("mode.debug", "mode.release")
-add_requires("gtest")
+add_requires("gtest", "benchmark")
 add_includedirs("include")
 add_languages("c++20")
 -- add_ldflags("$(shell pkg-config --libs --cflags icu-uc icu-io)")
 
+-- xmake f --stats=y: collect parse statistics (json-parser --stats)
+option("stats")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Compile in parse statistics (Stats.hpp)")
+    add_defines("JSON_PARSER_STATS")
+option_end()
+
 target("json-parser")
     set_kind("binary")
     add_files("src/*.cpp")
+    add_options("stats")
     
 
 target("test")
     add_files("tests/*.cpp")
-    add_files("src/Reader.cpp", "src/json.cpp")
+    add_files("src/*.cpp|main.cpp")
     add_packages("gtest")
+    add_options("stats")
+
+target("bench")
+    set_kind("binary")
+    add_files("bench/*.cpp")
+    add_files("src/*.cpp|main.cpp")
+    add_packages("benchmark")
+    add_options("stats")
 
 --
 -- If you want to known more usage about xmake, please see https://xmake.io